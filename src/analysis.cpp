@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <set>
+#include "analysis.h"
+#include "chip8.h"
+#include "opcodes.h"
+
+const BasicBlock* ROMAnalysis::blockAt(uint16_t start) const{
+  auto itBlock = blocks.find(start);
+  if (itBlock != blocks.end()){
+    return &itBlock->second;
+  }
+  return nullptr;
+}
+
+bool endsBlock(uint16_t opcode){
+  const OpInfo *info = decode(opcode);
+  if (!info){
+    return true;
+  }
+  switch (info->op){
+    case Op::RET:
+    case Op::JP:
+    case Op::CALL:
+    case Op::SE_BYTE:
+    case Op::SNE_BYTE:
+    case Op::SE_REG:
+    case Op::SNE_REG:
+    case Op::SKP:
+    case Op::SKNP:
+    case Op::JP_V0:
+    case Op::LD_K://loops on itself until a key is down
+      return true;
+    default:
+      return false;
+  }
+}
+
+//Addresses control can reach after the instruction at pc
+static std::vector<uint16_t> successorsOf(uint16_t pc, uint16_t opcode, bool &dynamicExit){
+  const OpInfo *info = decode(opcode);
+  dynamicExit = false;
+  if (!info){
+    return {};
+  }
+  uint16_t nnn = opcode & NNN_MASK;
+  switch (info->op){
+    case Op::JP:
+      return {nnn};
+    case Op::CALL:
+      return {nnn, static_cast<uint16_t>(pc + 2)};//assume the call returns
+    case Op::RET:
+    case Op::JP_V0:
+      dynamicExit = true;
+      return {};
+    case Op::SE_BYTE:
+    case Op::SNE_BYTE:
+    case Op::SE_REG:
+    case Op::SNE_REG:
+    case Op::SKP:
+    case Op::SKNP:
+      return {static_cast<uint16_t>(pc + 2), static_cast<uint16_t>(pc + 4)};
+    case Op::LD_K:
+      return {pc, static_cast<uint16_t>(pc + 2)};
+    default:
+      return {static_cast<uint16_t>(pc + 2)};
+  }
+}
+
+ROMAnalysis analyzeROM(const uint8_t *rom, size_t size){
+  ROMAnalysis analysis;
+  std::array<uint8_t,4096> ram{};
+  size = std::min(size, ram.size() - PROG_START_ADDR);
+  std::copy(rom, rom + size, ram.begin() + PROG_START_ADDR);
+  uint16_t romEnd = PROG_START_ADDR + size;
+  auto fetch = [&ram](uint16_t pc){ return static_cast<uint16_t>((ram[pc] << 8u) | ram[pc + 1]); };
+  auto inROM = [romEnd](uint16_t pc){ return pc >= PROG_START_ADDR && pc + 1 < romEnd; };
+
+  //Find every reachable instruction and the addresses that start blocks
+  std::set<uint16_t> leaders;
+  std::vector<bool> reached(ram.size());
+  std::vector<uint16_t> work;
+  leaders.insert(PROG_START_ADDR);
+  work.push_back(PROG_START_ADDR);
+  while (!work.empty()){
+    uint16_t pc = work.back();
+    work.pop_back();
+    if (!inROM(pc) || reached[pc]){
+      continue;
+    }
+    uint16_t opcode = fetch(pc);
+    if (!decode(opcode)){
+      continue;
+    }
+    reached[pc] = true;
+    analysis.bytes[pc] |= BYTE_CODE;
+    analysis.bytes[pc + 1] |= BYTE_CODE;
+    bool dynamicExit;
+    std::vector<uint16_t> next = successorsOf(pc, opcode, dynamicExit);
+    for (uint16_t target : next){
+      if (endsBlock(opcode)){
+        leaders.insert(target);
+      }
+      work.push_back(target);
+    }
+  }
+
+  //Cut the reachable instructions into blocks
+  for (uint16_t start : leaders){
+    if (!inROM(start) || !reached[start]){
+      continue;
+    }
+    BasicBlock block;
+    block.start = start;
+    uint16_t pc = start;
+    bool indexKnown = false;
+    uint16_t index = 0;
+    while (true){
+      uint16_t opcode = fetch(pc);
+      const OpInfo *info = decode(opcode);
+      //Only writes and sprite reads through an I set in this block are tracked
+      int touched = ramWriteLength(opcode);
+      uint8_t flag = BYTE_WRITTEN;
+      switch (info->op){
+        case Op::LD_I:
+          indexKnown = true;
+          index = opcode & NNN_MASK;
+          break;
+        case Op::DRW:
+          touched = opcode & N_MASK;
+          flag = BYTE_SPRITE;
+          break;
+        default:
+          break;
+      }
+      for (int i = 0; indexKnown && i < touched && index + i < 4096; ++i){
+        analysis.bytes[index + i] |= flag;
+      }
+      //Some quirk profiles advance I on LD [I] and LD Vx, [I]
+      if (info->op == Op::ADD_I || info->op == Op::LD_F || info->op == Op::STORE || info->op == Op::LOAD){
+        indexKnown = false;
+      }
+      uint16_t next = pc + 2;
+      if (endsBlock(opcode)){
+        block.successors = successorsOf(pc, opcode, block.dynamicExit);
+        block.end = next;
+        break;
+      }
+      if (leaders.count(next) || !inROM(next) || !reached[next]){
+        block.successors.push_back(next);
+        block.end = next;
+        break;
+      }
+      pc = next;
+    }
+    analysis.blocks[start] = block;
+  }
+
+  for (uint16_t addr = PROG_START_ADDR; addr < romEnd; ++addr){
+    if (!(analysis.bytes[addr] & BYTE_CODE)){
+      analysis.bytes[addr] |= BYTE_DATA;
+    }
+    else if (analysis.bytes[addr] & BYTE_WRITTEN){
+      analysis.selfModifying.push_back(addr);
+    }
+  }
+  return analysis;
+}
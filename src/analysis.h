@@ -0,0 +1,40 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+//Per byte flags in ROMAnalysis::bytes
+const uint8_t BYTE_CODE = 0x1u; //part of a reachable instruction
+const uint8_t BYTE_DATA = 0x2u; //inside the ROM but never executed
+const uint8_t BYTE_SPRITE = 0x4u; //read by DRW with a known I
+const uint8_t BYTE_WRITTEN = 0x8u; //written by LD B or LD [I] with a known I
+
+//Straight line run of instructions entered only at start.
+struct BasicBlock{
+  uint16_t start{};
+  uint16_t end{};//one past the last instruction
+  std::vector<uint16_t> successors;
+  bool dynamicExit{};//ends in RET or JP V0, targets only known at run time
+};
+
+struct ROMAnalysis{
+  std::map<uint16_t, BasicBlock> blocks;//keyed by start address
+  std::array<uint8_t,4096> bytes{};
+  std::vector<uint16_t> selfModifying;//code addresses the program may overwrite
+
+  const BasicBlock* blockAt(uint16_t start) const;
+};
+
+/*Static pass over a ROM loaded at PROG_START_ADDR. Follows JP, CALL, RET
+and the skips from the entry point to build the control flow graph, then
+marks everything unreached as data. I is tracked within each block so
+sprite reads and RAM writes through a constant LD I are attributed.*/
+ROMAnalysis analyzeROM(const uint8_t *rom, size_t size);
+
+//Whether executing op ends a basic block
+bool endsBlock(uint16_t opcode);
+#endif
@@ -0,0 +1,99 @@
+#include "capture.h"
+#include "chip8.h"
+#include "quirks.h"
+#include "timing.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+//Runs ROMs headless for a fixed number of cycles, picking each ROM's quirk
+//profile from a database keyed by ROM hash. Pass - to skip the database.
+//With --capture every frame is recorded to <Dir>/<ROM name>.c8f. With
+//--timed the count is 60 Hz frames run on the VIP timing model instead of
+//cycles, and the emulated clock rate is reported next to IPS.
+int main(int argc, char **argv){
+  std::string captureDir;
+  bool timed = false;
+  while (argc > 1){
+    std::string option = argv[1];
+    if (option == "--capture" && argc > 2){
+      captureDir = argv[2];
+      argc -= 2;
+      argv += 2;
+    }
+    else if (option == "--timed"){
+      timed = true;
+      --argc;
+      ++argv;
+    }
+    else {
+      break;
+    }
+  }
+  if (argc < 4){
+    std::cerr << "Usage: " << argv[0] << " [--capture <Dir>] [--timed] <Cycles|Frames> <QuirkDB|-> <ROM>..." << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  long cycles = std::stol(argv[1]);
+  std::string dbFilename = argv[2];
+
+  QuirkDatabase database;
+  if (dbFilename != "-" && !database.load(dbFilename)){
+    std::cerr << "Could not read quirk database " << dbFilename << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  for (int arg = 3; arg < argc; ++arg){
+    std::string romFilename = argv[arg];
+    uint64_t hash = hashROM(romFilename);
+    QuirkProfile profile = database.lookup(hash);
+
+    Chip8 chip8(profile);
+    chip8.loadROM(romFilename);
+
+    std::unique_ptr<FrameSink> capture;
+    if (!captureDir.empty()){
+      std::string name = romFilename.substr(romFilename.find_last_of('/') + 1);
+      capture = std::make_unique<FrameSink>(captureDir + "/" + name + ".c8f");
+      if (!capture->isOpen()){
+        std::cerr << "Could not write capture for " << romFilename << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+    }
+
+    FrameScheduler scheduler(chip8);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (long i = 0; i < cycles; ++i){
+      if (timed){
+        scheduler.runFrame();
+        if (capture){
+          capture->submit(chip8.display);
+        }
+        continue;
+      }
+      chip8.cycle();
+      if (capture && (i + 1) % CYCLES_PER_FRAME == 0){
+        capture->submit(chip8.display);
+      }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << romFilename << " " << std::hex << hash << std::dec
+              << " " << quirkProfileName(profile);
+    if (timed){
+      uint64_t instructions = scheduler.getInstructions();
+      std::cout << " " << cycles << " frames"
+                << " " << double(instructions) / cycles << " instructions/frame"
+                << " " << (seconds > 0 ? instructions / seconds : 0) << " IPS"
+                << " " << scheduler.emulatedMHz(seconds) << " MHz" << std::endl;
+    }
+    else {
+      std::cout << " " << cycles << " cycles"
+                << " " << (seconds > 0 ? cycles / seconds : 0) << " IPS" << std::endl;
+    }
+  }
+  return 0;
+}
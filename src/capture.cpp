@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "capture.h"
+#include "varint.h"
+
+void packFrame(const uint32_t *display, PackedFrame &frame){
+  for (size_t byte = 0; byte < FRAME_BYTES; ++byte){
+    uint8_t bits = 0;
+    for (int bit = 0; bit < 8; ++bit){
+      bits = (bits << 1u) | (display[byte * 8 + bit] != 0);
+    }
+    frame[byte] = bits;
+  }
+}
+
+FrameSink::FrameSink(const std::string &filename){
+  file = std::fopen(filename.c_str(), "wb");
+  if (!file){
+    return;
+  }
+  uint8_t header[] = {CAPTURE_VERSION, DISP_W, DISP_H};
+  std::fwrite(CAPTURE_MAGIC, 1, sizeof(CAPTURE_MAGIC), file);
+  std::fwrite(header, 1, sizeof(header), file);
+  encoder = std::thread(&FrameSink::encodeLoop, this);
+}
+
+FrameSink::~FrameSink(){
+  if (!file){
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (repeats){
+      queue.push_back({current, repeats});
+    }
+    stopping = true;
+  }
+  ready.notify_one();
+  encoder.join();
+  std::fclose(file);
+}
+
+void FrameSink::submit(const uint32_t *display){
+  PackedFrame frame;
+  packFrame(display, frame);
+  if (repeats && frame == current){
+    ++repeats;
+    return;
+  }
+  //A frame's record is only complete once we know how long it stayed up
+  if (repeats){
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back({current, repeats});
+    }
+    ready.notify_one();
+  }
+  current = frame;
+  repeats = 1;
+}
+
+void FrameSink::encodeLoop(){
+  PackedFrame previous{};
+  //Every token but the last carries a literal, so there are at most FRAME_BYTES + 1
+  std::vector<uint8_t> out(VARINT_MAX_BYTES + (FRAME_BYTES + 1) * 2 * VARINT_MAX_BYTES + FRAME_BYTES);
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true){
+    ready.wait(lock, [this]{ return !queue.empty() || stopping; });
+    if (queue.empty()){
+      break;
+    }
+    Pending pending = queue.front();
+    queue.pop_front();
+    lock.unlock();
+
+    uint8_t *end = putVarint(out.data(), pending.repeats);
+    size_t i = 0;
+    while (i < FRAME_BYTES){
+      size_t zeros = 0;
+      while (i + zeros < FRAME_BYTES && pending.frame[i + zeros] == previous[i + zeros]){
+        ++zeros;
+      }
+      i += zeros;
+      size_t literals = 0;
+      while (i + literals < FRAME_BYTES && pending.frame[i + literals] != previous[i + literals]){
+        ++literals;
+      }
+      end = putVarint(end, zeros);
+      end = putVarint(end, literals);
+      for (size_t j = 0; j < literals; ++j, ++i){
+        *end++ = pending.frame[i] ^ previous[i];
+      }
+    }
+    std::fwrite(out.data(), 1, end - out.data(), file);
+    previous = pending.frame;
+    lock.lock();
+  }
+}
+
+FrameReader::FrameReader(const std::string &filename) : file(filename, std::ios::binary){
+  char header[sizeof(CAPTURE_MAGIC) + 3];
+  if (file.read(header, sizeof(header))){
+    valid = std::memcmp(header, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0 &&
+            static_cast<uint8_t>(header[4]) == CAPTURE_VERSION &&
+            static_cast<uint8_t>(header[5]) == DISP_W && static_cast<uint8_t>(header[6]) == DISP_H;
+  }
+}
+
+bool FrameReader::next(PackedFrame &frame, uint32_t &repeats){
+  if (!valid || !getVarint(file, repeats)){
+    return false;
+  }
+  size_t i = 0;
+  while (i < FRAME_BYTES){
+    uint32_t zeros;
+    uint32_t literals;
+    if (!getVarint(file, zeros) || !getVarint(file, literals) || i + zeros + literals > FRAME_BYTES){
+      valid = false;
+      return false;
+    }
+    i += zeros;
+    for (uint32_t j = 0; j < literals; ++j, ++i){
+      previous[i] ^= static_cast<uint8_t>(file.get());
+    }
+  }
+  if (!file){
+    valid = false;
+    return false;
+  }
+  frame = previous;
+  return true;
+}
+
+static bool pixelOn(const PackedFrame &frame, int x, int y){
+  int bit = y * DISP_W + x;
+  return frame[bit / 8] & (0x80u >> (bit % 8));
+}
+
+bool writeY4MHeader(std::ostream &out, int scale){
+  out << "YUV4MPEG2 W" << DISP_W * scale << " H" << DISP_H * scale << " F60:1 Ip A1:1 C420jpeg\n";
+  return static_cast<bool>(out);
+}
+
+void writeY4MFrame(std::ostream &out, const PackedFrame &frame, int scale){
+  int width = DISP_W * scale;
+  int height = DISP_H * scale;
+  std::vector<char> plane(width * height);
+  for (int y = 0; y < height; ++y){
+    for (int x = 0; x < width; ++x){
+      plane[y * width + x] = static_cast<char>(pixelOn(frame, x / scale, y / scale) ? 235 : 16);
+    }
+  }
+  out << "FRAME\n";
+  out.write(plane.data(), plane.size());
+  //Grey chroma for both subsampled planes
+  std::vector<char> chroma(width * height / 2, static_cast<char>(128));
+  out.write(chroma.data(), chroma.size());
+}
+
+static uint32_t crc32(const uint8_t *data, size_t size, uint32_t crc = 0){
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i){
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; ++bit){
+      crc = (crc >> 1u) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+static void appendBigEndian(std::vector<uint8_t> &out, uint32_t value){
+  for (int shift = 24; shift >= 0; shift -= 8){
+    out.push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+static void appendChunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data){
+  appendBigEndian(png, data.size());
+  size_t start = png.size();
+  png.insert(png.end(), type, type + 4);
+  png.insert(png.end(), data.begin(), data.end());
+  appendBigEndian(png, crc32(png.data() + start, png.size() - start));
+}
+
+bool writePNG(const std::string &filename, const PackedFrame &frame, int scale){
+  uint32_t width = DISP_W * scale;
+  uint32_t height = DISP_H * scale;
+  size_t rowBytes = (width + 7) / 8;
+
+  //1 bit greyscale rows, each behind a "no filter" byte
+  std::vector<uint8_t> raw;
+  for (uint32_t y = 0; y < height; ++y){
+    raw.push_back(0);
+    for (size_t byte = 0; byte < rowBytes; ++byte){
+      uint8_t bits = 0;
+      for (uint32_t bit = 0; bit < 8; ++bit){
+        uint32_t x = byte * 8 + bit;
+        bits = (bits << 1u) | (x < width && pixelOn(frame, x / scale, y / scale));
+      }
+      raw.push_back(bits);
+    }
+  }
+
+  //zlib stream made of stored deflate blocks, the frames are tiny anyway
+  std::vector<uint8_t> zlib = {0x78, 0x01};
+  uint32_t a = 1;
+  uint32_t b = 0;
+  for (uint8_t byte : raw){
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  size_t offset = 0;
+  do {
+    size_t length = std::min<size_t>(raw.size() - offset, 65535);
+    bool last = offset + length == raw.size();
+    zlib.push_back(last);
+    zlib.push_back(length & 0xFFu);
+    zlib.push_back(length >> 8u);
+    zlib.push_back(~length & 0xFFu);
+    zlib.push_back((~length >> 8u) & 0xFFu);
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+    offset += length;
+  } while (offset < raw.size());
+  appendBigEndian(zlib, (b << 16u) | a);
+
+  std::vector<uint8_t> header;
+  appendBigEndian(header, width);
+  appendBigEndian(header, height);
+  header.insert(header.end(), {1, 0, 0, 0, 0});//bit depth 1, greyscale
+
+  std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  appendChunk(png, "IHDR", header);
+  appendChunk(png, "IDAT", zlib);
+  appendChunk(png, "IEND", {});
+
+  std::ofstream out(filename, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(png.data()), png.size());
+  return static_cast<bool>(out);
+}
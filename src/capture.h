@@ -0,0 +1,71 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "chip8.h"
+
+const size_t FRAME_BYTES = DISP_W * DISP_H / 8;
+typedef std::array<uint8_t, FRAME_BYTES> PackedFrame;//1bpp, MSB is the leftmost pixel
+
+/*Capture stream: CAPTURE_MAGIC, version byte, width, height, then one record
+per distinct frame:
+  varint  number of 60 Hz frames it stayed on screen
+  tokens  XOR with the previous frame as (varint zero run, varint literal
+          count, literal bytes) until FRAME_BYTES are covered*/
+const char CAPTURE_MAGIC[4] = {'C', '8', 'F', 'R'};
+const uint8_t CAPTURE_VERSION = 1;
+
+void packFrame(const uint32_t *display, PackedFrame &frame);
+
+//Takes the framebuffer once per frame and encodes it on its own thread.
+//Identical consecutive frames only bump a counter.
+class FrameSink{
+public:
+  explicit FrameSink(const std::string &filename);
+  ~FrameSink();
+  bool isOpen() const { return file != nullptr; }
+  void submit(const uint32_t *display);
+
+private:
+  struct Pending{
+    PackedFrame frame;
+    uint32_t repeats;
+  };
+  void encodeLoop();
+
+  std::FILE *file{};
+  PackedFrame current{};
+  uint32_t repeats{};
+  std::deque<Pending> queue;
+  std::mutex mutex;
+  std::condition_variable ready;
+  bool stopping{};
+  std::thread encoder;
+};
+
+//Decodes a capture stream one distinct frame at a time.
+class FrameReader{
+public:
+  explicit FrameReader(const std::string &filename);
+  bool isOpen() const { return valid; }
+  bool next(PackedFrame &frame, uint32_t &repeats);
+
+private:
+  std::ifstream file;
+  bool valid{};
+  PackedFrame previous{};
+};
+
+//Writers for the exporter. scale repeats every pixel scale x scale times.
+bool writeY4MHeader(std::ostream &out, int scale);
+void writeY4MFrame(std::ostream &out, const PackedFrame &frame, int scale);
+bool writePNG(const std::string &filename, const PackedFrame &frame, int scale);
+#endif
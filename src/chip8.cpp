@@ -1,7 +1,12 @@
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <random>
 #include "chip8.h"
+#include "opcodes.h"
+#include "trace.h"
 
 
 
@@ -21,50 +26,56 @@ std::array<uint8_t, FONTSET_SIZE> fontset = { 0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
                                             	0xE0, 0x90, 0x90, 0x90, 0xE0, // D
                                             	0xF0, 0x80, 0xF0, 0x80, 0xF0, // E
                                             	0xF0, 0x80, 0xF0, 0x80, 0x80 }; // F
-Chip8::Chip8(){
+Chip8::Chip8(QuirkProfile profile){
   //Create opcode to function pointer
+  HandlerTable handlers{};
+  handler(handlers, Op::CLS) = &Chip8::i00E0;
+  handler(handlers, Op::RET) = &Chip8::i00EE;
+  handler(handlers, Op::JP) = &Chip8::i1nnn;
+  handler(handlers, Op::CALL) = &Chip8::i2nnn;
+  handler(handlers, Op::SE_BYTE) = &Chip8::i3xkk;
+  handler(handlers, Op::SNE_BYTE) = &Chip8::i4xkk;
+  handler(handlers, Op::SE_REG) = &Chip8::i5xy0;
+  handler(handlers, Op::LD_BYTE) = &Chip8::i6xkk;
+  handler(handlers, Op::ADD_BYTE) = &Chip8::i7xkk;
+  handler(handlers, Op::SNE_REG) = &Chip8::i9xy0;
+  handler(handlers, Op::LD_I) = &Chip8::iAnnn;
+  handler(handlers, Op::RND) = &Chip8::iCxkk;
+  handler(handlers, Op::SKP) = &Chip8::iEx9E;
+  handler(handlers, Op::SKNP) = &Chip8::iExA1;
+  handler(handlers, Op::LD_VX_DT) = &Chip8::iFx07;
+  handler(handlers, Op::LD_K) = &Chip8::iFx0A;
+  handler(handlers, Op::LD_DT) = &Chip8::iFx15;
+  handler(handlers, Op::LD_ST) = &Chip8::iFx18;
+  handler(handlers, Op::ADD_I) = &Chip8::iFx1E;
+  handler(handlers, Op::LD_F) = &Chip8::iFx29;
+  handler(handlers, Op::LD_B) = &Chip8::iFx33;
+
+  switch (profile){
+    case QuirkProfile::CosmacVIP: installQuirks<CosmacVIPQuirks>(handlers); break;
+    case QuirkProfile::Chip48: installQuirks<Chip48Quirks>(handlers); break;
+    case QuirkProfile::SChip: installQuirks<SChipQuirks>(handlers); break;
+    case QuirkProfile::Modern: installQuirks<ModernQuirks>(handlers); break;
+    case QuirkProfile::XOChip: installQuirks<XOChipQuirks>(handlers); break;
+  }
+
+  //Fill the dispatch maps from the decode table shared with the disassembler
   opMap.insert(std::make_pair(0x0000, &Chip8::op0));
-  opMap.insert(std::make_pair(0x1000, &Chip8::i1nnn));
-  opMap.insert(std::make_pair(0x2000, &Chip8::i2nnn));
-  opMap.insert(std::make_pair(0x3000, &Chip8::i3xkk));
-  opMap.insert(std::make_pair(0x4000, &Chip8::i4xkk));
-  opMap.insert(std::make_pair(0x5000, &Chip8::i5xy0));
-  opMap.insert(std::make_pair(0x6000, &Chip8::i6xkk));
-  opMap.insert(std::make_pair(0x7000, &Chip8::i7xkk));
   opMap.insert(std::make_pair(0x8000, &Chip8::op8));
-  opMap.insert(std::make_pair(0x9000, &Chip8::i9xy0));
-  opMap.insert(std::make_pair(0xA000, &Chip8::iAnnn));
-  opMap.insert(std::make_pair(0xB000, &Chip8::iBnnn));
-  opMap.insert(std::make_pair(0xC000, &Chip8::iCxkk));
-  opMap.insert(std::make_pair(0xD000, &Chip8::iDxyn));
   opMap.insert(std::make_pair(0xE000, &Chip8::opE));
   opMap.insert(std::make_pair(0xF000, &Chip8::opF));
-
-  opMap0.insert(std::make_pair(0x0, &Chip8::i00E0));
-  opMap0.insert(std::make_pair(0xE, &Chip8::i00EE));
-
-  opMap8.insert(std::make_pair(0x0, &Chip8::i8xy0));
-  opMap8.insert(std::make_pair(0x1, &Chip8::i8xy1));
-  opMap8.insert(std::make_pair(0x2, &Chip8::i8xy2));
-  opMap8.insert(std::make_pair(0x3, &Chip8::i8xy3));
-  opMap8.insert(std::make_pair(0x4, &Chip8::i8xy4));
-  opMap8.insert(std::make_pair(0x5, &Chip8::i8xy5));
-  opMap8.insert(std::make_pair(0x6, &Chip8::i8xy6));
-  opMap8.insert(std::make_pair(0x7, &Chip8::i8xy7));
-  opMap8.insert(std::make_pair(0xE, &Chip8::i8xyE));
-
-  opMapE.insert(std::make_pair(0x1, &Chip8::iExA1));
-  opMapE.insert(std::make_pair(0xE, &Chip8::iEx9E));
-
-  opMapF.insert(std::make_pair(0x07, &Chip8::iFx07));
-  opMapF.insert(std::make_pair(0x0A, &Chip8::iFx0A));
-  opMapF.insert(std::make_pair(0x15, &Chip8::iFx15));
-  opMapF.insert(std::make_pair(0x18, &Chip8::iFx18));
-  opMapF.insert(std::make_pair(0x1E, &Chip8::iFx1E));
-  opMapF.insert(std::make_pair(0x29, &Chip8::iFx29));
-  opMapF.insert(std::make_pair(0x33, &Chip8::iFx33));
-  opMapF.insert(std::make_pair(0x55, &Chip8::iFx55));
-  opMapF.insert(std::make_pair(0x65, &Chip8::iFx65));
+  for (const OpInfo &info : OP_TABLE){
+    if (info.family == 0x8000){
+      continue;//op8 indexes aluHandlers instead
+    }
+    MFP operation = handler(handlers, info.op);
+    switch (info.family){
+      case 0x0000: opMap0.insert(std::make_pair(info.key, operation)); break;
+      case 0xE000: opMapE.insert(std::make_pair(info.key, operation)); break;
+      case 0xF000: opMapF.insert(std::make_pair(info.key, operation)); break;
+      default: opMap.insert(std::make_pair(info.family, operation)); break;
+    }
+  }
 
   //Initialize program counter
   programCounter = PROG_START_ADDR;
@@ -76,6 +87,21 @@ Chip8::Chip8(){
   generator.seed(device());
 }
 
+template <typename Q, size_t... N>
+constexpr std::array<Chip8::MFP,16> Chip8::aluTable(std::index_sequence<N...>){
+  return {{&Chip8::i8xyN<N,Q>...}};
+}
+
+template <typename Q>
+void Chip8::installQuirks(HandlerTable &handlers){
+  static constexpr std::array<MFP,16> ALU = aluTable<Q>(std::make_index_sequence<16>{});
+  aluHandlers = ALU.data();
+  handler(handlers, Op::JP_V0) = &Chip8::iBnnn<Q>;
+  handler(handlers, Op::DRW) = &Chip8::iDxyn<Q>;
+  handler(handlers, Op::STORE) = &Chip8::iFx55<Q>;
+  handler(handlers, Op::LOAD) = &Chip8::iFx65<Q>;
+}
+
 void Chip8::loadROM(const std::string &filename){
   //Open file as a binary stream and move ptr to the end
   std::ifstream file(filename, std::ios::binary | std::ios::ate);
@@ -99,7 +125,71 @@ void Chip8::loadROM(const std::string &filename){
   }
 }
 
+void Chip8::loadROM(const uint8_t *data, size_t size){
+  size = std::min(size, ram.size() - PROG_START_ADDR);
+  std::copy(data, data + size, ram.begin() + PROG_START_ADDR);
+}
+
+void Chip8::seed(uint32_t value){
+  generator.seed(value);
+  randByte.reset();
+}
+
+void Chip8::saveInto(Chip8State &state) const{
+  state.ram = ram;
+  state.registers = registers;
+  state.stack = stack;
+  state.index = index;
+  state.delay = delay;
+  state.sound = sound;
+  state.programCounter = programCounter;
+  state.stackPointer = stackPointer;
+  std::copy(std::begin(keyboard), std::end(keyboard), state.keyboard.begin());
+  std::copy(std::begin(display), std::end(display), state.display.begin());
+}
+
+Chip8State Chip8::save() const{
+  Chip8State state;
+  saveInto(state);
+  return state;
+}
+
+void Chip8::restore(const Chip8State &state){
+  ram = state.ram;
+  registers = state.registers;
+  stack = state.stack;
+  index = state.index;
+  delay = state.delay;
+  sound = state.sound;
+  programCounter = state.programCounter;
+  stackPointer = state.stackPointer;
+  std::copy(state.keyboard.begin(), state.keyboard.end(), keyboard);
+  std::copy(state.display.begin(), state.display.end(), display);
+}
+
+void Chip8::save(Chip8Snapshot &snapshot) const{
+  saveInto(snapshot.state);
+  snapshot.generator = generator;
+}
+
+void Chip8::restore(const Chip8Snapshot &snapshot){
+  restore(snapshot.state);
+  generator = snapshot.generator;
+}
+
+bool Chip8State::operator==(const Chip8State &other) const{
+  return programCounter == other.programCounter && index == other.index &&
+         registers == other.registers && stackPointer == other.stackPointer &&
+         stack == other.stack && delay == other.delay && sound == other.sound &&
+         keyboard == other.keyboard && ram == other.ram && display == other.display;
+}
+
 void Chip8::cycle(){
+  step();
+  tickTimers();
+}
+
+void Chip8::step(){
   //Decode opcode
   opcode = (ram[programCounter] << 8u) | ram[programCounter + 1];
   //Increment programCounter
@@ -111,6 +201,9 @@ void Chip8::cycle(){
     MFP operation = opMap[(opcode & OP_CODE_MASK)];
     std::invoke(operation,this);
   }
+}
+
+void Chip8::tickTimers(){
   //Sound and Delay decrements
   if (delay > 0){
     --delay;
@@ -121,6 +214,82 @@ void Chip8::cycle(){
   }
 }
 
+void Chip8::cycle(TraceWriter &trace){
+  if (!trace.isOpen()){
+    cycle();
+    return;
+  }
+  uint16_t pc = programCounter;
+  uint16_t address = index;
+  //Only LD Vx, [I] writes more than Vx and VF. Copying all 16 registers would
+  //read them back right after the last instruction wrote one, which stalls.
+  uint16_t next = (ram[programCounter] << 8u) | ram[programCounter + 1];
+  uint8_t x = (next & VX_MASK) >> 8u;
+  bool loads = (next & 0xF0FFu) == 0xF065u;
+  std::array<uint8_t,16> before;
+  if (loads){
+    before = registers;
+  }
+  else {
+    before[x] = registers[x];
+    before[0xF] = registers[0xF];
+  }
+  uint8_t stackPointerBefore = stackPointer;
+  uint8_t delayBefore = delay;
+  uint8_t soundBefore = sound;
+
+  cycle();
+
+  uint32_t mask = 0;
+  if (!loads){
+    mask = static_cast<uint32_t>(registers[x] != before[x]) << x |
+           static_cast<uint32_t>(registers[0xF] != before[0xF]) << 0xFu;
+  }
+  else if (registers != before){
+    for (int i = 0; i < 16; ++i){
+      mask |= static_cast<uint32_t>(registers[i] != before[i]) << i;
+    }
+  }
+  uint16_t written = ramWriteLength(opcode);
+  if (index != trace.lastIndex) mask |= TRACE_INDEX;
+  if (stackPointer != stackPointerBefore) mask |= TRACE_SP;
+  if (delay != delayBefore) mask |= TRACE_DELAY;
+  if (sound != soundBefore) mask |= TRACE_SOUND;
+  if (written) mask |= TRACE_MEMORY;
+
+  uint8_t *out = trace.begin();
+  out = putSigned(out, pc - trace.lastPC);
+  trace.lastPC = pc;
+  *out++ = opcode >> 8u;
+  *out++ = opcode & 0xFFu;
+  out = putVarint(out, mask);
+  if (!loads){
+    if (mask & (1u << x)) *out++ = registers[x];
+    if (x != 0xF && (mask & 0x8000u)) *out++ = registers[0xF];
+  }
+  else {
+    for (int i = 0; i < 16; ++i){
+      if (mask & (1u << i)){
+        *out++ = registers[i];
+      }
+    }
+  }
+  if (mask & TRACE_INDEX){
+    out = putSigned(out, index - trace.lastIndex);
+    trace.lastIndex = index;
+  }
+  if (mask & TRACE_SP) *out++ = stackPointer;
+  if (mask & TRACE_DELAY) *out++ = delay;
+  if (mask & TRACE_SOUND) *out++ = sound;
+  if (written){
+    out = putVarint(out, address);
+    out = putVarint(out, written);
+    std::copy(ram.begin() + address, ram.begin() + address + written, out);
+    out += written;
+  }
+  trace.endRecord(out);
+}
+
 void Chip8::op0(){
   auto itMap0 = opMap0.find(opcode & 0x000Fu);
   if (itMap0 != opMap0.end()){
@@ -130,11 +299,8 @@ void Chip8::op0(){
 }
 
 void Chip8::op8(){
-  auto itMap8 = opMap8.find(opcode & 0x000Fu);
-  if (itMap8 != opMap8.end()){
-    MFP operation8 = opMap8[opcode & 0x000Fu];
-    std::invoke(operation8, this);
-  }
+  //Every N has an entry, so no second map lookup
+  std::invoke(aluHandlers[opcode & 0x000Fu], this);
 }
 
 void Chip8::opE(){
@@ -214,84 +380,55 @@ void Chip8::i7xkk(){
   uint8_t kk = opcode & KK_MASK;
   registers[Vx]+=kk;
 }
-void Chip8::i8xy0(){
-  // (LD Vx, Vy) set Vx = Vy
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  uint8_t Vy = (opcode & VY_MASK)>>4u;
-  registers[Vx]=registers[Vy];
-}
-void Chip8::i8xy1(){
-  //(OR Vx, Vy) set Vx = Vx OR Vy
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  uint8_t Vy = (opcode & VY_MASK)>>4u;
-  registers[Vx] |= registers[Vy];
-}
-void Chip8::i8xy2(){
-  //(AND Vx, Vy)
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  uint8_t Vy = (opcode & VY_MASK)>>4u;
-  registers[Vx] &= registers[Vy];
-}
-void Chip8::i8xy3(){
-  //(XOR)
+template <uint8_t N, typename Q>
+void Chip8::i8xyN(){
   uint8_t Vx = (opcode & VX_MASK)>>8u;
   uint8_t Vy = (opcode & VY_MASK)>>4u;
-  registers[Vx] ^= registers[Vy];
-}
-void Chip8::i8xy4(){
-  //(ADD w/ VF=carry)
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  uint8_t Vy = (opcode & VY_MASK)>>4u;
-  uint16_t sum = registers[Vx]+registers[Vy];
-  if (sum > 255u){
-    registers[0xF]=1;
+  unsigned x = registers[Vx];
+  unsigned y = registers[Vy];
+  if constexpr (N == 0x0){
+    registers[Vx] = y;
+  }
+  else if constexpr (N == 0x1 || N == 0x2 || N == 0x3){
+    if constexpr (N == 0x1){
+      registers[Vx] = x | y;
     }
-    else{
-      registers[0xF]=0;
+    else if constexpr (N == 0x2){
+      registers[Vx] = x & y;
+    }
+    else {
+      registers[Vx] = x ^ y;
+    }
+    if constexpr (Q::logicResetsVF){
+      registers[0xF] = 0;
     }
-    registers[Vx] = sum & 0xFFu;
-}
-void Chip8::i8xy5(){
-  //If Vx > Vy, then VF is set to 1, otherwise 0.
-  //Then Vy is subtracted from Vx, and the results stored in Vx.
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  uint8_t Vy = (opcode & VY_MASK)>>4u;
-  if (registers[Vx]>registers[Vy]){
-    registers[0xF] = 1;
   }
-  else {
-    registers[0xF] = 0;
+  else if constexpr (N == 0x4){
+    //VF = carry, bit 8 of the sum
+    unsigned sum = x + y;
+    registers[Vx] = sum;
+    registers[0xF] = sum >> 8u;
   }
-  registers[Vx]-=registers[Vy];
-}
-
-void Chip8::i8xy6(){
-  //If the least-significant bit of Vx is 1, then VF is set to 1,
-  //otherwise 0. Then Vx is divided by 2.
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  registers[0xF]=registers[Vx]&0x1u;
-  registers[Vx]>>=1;
-}
-
-void Chip8::i8xy7(){
-  //If Vy > Vx, then VF is set to 1, otherwise 0.
-  //Then Vx is subtracted from Vy, and the results stored in Vx.
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  uint8_t Vy = (opcode & VY_MASK)>>4u;
-  if (registers[Vy]>registers[Vx]){
-    registers[0xF] = 1;
+  else if constexpr (N == 0x5 || N == 0x7){
+    //VF = NOT borrow, a borrow sets every bit above 7 of the difference
+    unsigned difference = N == 0x5 ? x - y : y - x;
+    registers[Vx] = difference;
+    registers[0xF] = ((difference >> 8u) & 0x1u) ^ 0x1u;
   }
-  else {
-    registers[0xF] = 0;
+  else if constexpr (N == 0x6 || N == 0xE){
+    //VF = the bit shifted out. The VIP shifts Vy into Vx instead.
+    unsigned source = Q::shiftUsesVy ? y : x;
+    if constexpr (N == 0x6){
+      registers[Vx] = source >> 1u;
+      registers[0xF] = source & 0x1u;
+    }
+    else {
+      registers[Vx] = source << 1u;
+      registers[0xF] = source >> 7u;
+    }
   }
-  registers[Vx]=registers[Vy]-registers[Vx];
 }
 
-void Chip8::i8xyE(){
-  uint8_t Vx = (opcode & VX_MASK)>>8u;
-  registers[0xF]=registers[Vx]&0x80u;
-  registers[Vx]<<=1;
-}
 void Chip8::i9xy0(){
   // skip next instruction if Vx!= Vy
   uint8_t Vx = (opcode & VX_MASK)>>8u;
@@ -305,10 +442,17 @@ void Chip8::iAnnn(){
   uint16_t address = opcode & NNN_MASK;
   index = address;
 }
+template <typename Q>
 void Chip8::iBnnn(){
   //The program counter is set to nnn plus the value of V0.
+  //CHIP-48 and SCHIP read it as Bxnn and add Vx instead.
   uint16_t address = opcode & NNN_MASK;
-  programCounter = registers[0] + address;
+  if constexpr (Q::jumpUsesVx){
+    programCounter = registers[(opcode & VX_MASK)>>8u] + address;
+  }
+  else {
+    programCounter = registers[0] + address;
+  }
 }
 
 void Chip8::iCxkk(){
@@ -318,6 +462,7 @@ void Chip8::iCxkk(){
   registers[Vx] = randByte(generator) & kk;
 }
 
+template <typename Q>
 void Chip8::iDxyn(){
   /*Display n-byte sprite starting at memory location I at (Vx, Vy),
   set VF = collision.
@@ -332,10 +477,24 @@ void Chip8::iDxyn(){
   uint8_t yPos = registers[Vy] % DISP_H;
   registers[0xF] = 0;
   for (int row = 0; row<n;row++){
+    int y = yPos + row;
+    if constexpr (Q::spriteWraps){
+      y %= DISP_H;
+    }
+    else if (y >= DISP_H){
+      break;//clip at the bottom edge
+    }
     uint8_t spriteByte = ram[index+row];
     for (int col = 0; col < 8; col++ ){
+      int x = xPos + col;
+      if constexpr (Q::spriteWraps){
+        x %= DISP_W;
+      }
+      else if (x >= DISP_W){
+        break;//clip at the right edge
+      }
       uint8_t spritePixel = spriteByte & (0x80u >> col);
-			uint32_t* screenPixel = &display[(yPos + row) * DISP_W + (xPos + col)];
+			uint32_t* screenPixel = &display[y * DISP_W + x];
 
       //sprite pixel on
       if (spritePixel){
@@ -352,7 +511,7 @@ void Chip8::iEx9E(){
   //Checks the keyboard, and if the key corresponding to the value of Vx is
   //currently in the down position, PC is increased by 2.*/
   uint8_t Vx = (opcode & VX_MASK) >> 8u;
-	uint8_t key = registers[Vx];
+	uint8_t key = registers[Vx] & 0xFu;//only the low nibble selects a key
 
 	if (keyboard[key])
 	{
@@ -362,7 +521,7 @@ void Chip8::iEx9E(){
 void Chip8::iExA1(){
   //Skips next instruction if key not pressed
   uint8_t Vx = (opcode & VX_MASK) >> 8u;
-	uint8_t key = registers[Vx];
+	uint8_t key = registers[Vx] & 0xFu;//only the low nibble selects a key
 
 	if (!keyboard[key])
 	{
@@ -487,6 +646,7 @@ void Chip8::iFx33(){
   // Hundreds
   ram[index] = value % 10;
 }
+template <typename Q>
 void Chip8::iFx55(){
   /*Store registers V0 through Vx in memory starting at location I.
 
@@ -498,7 +658,14 @@ void Chip8::iFx55(){
 	{
 		ram[index + i] = registers[i];
 	}
+  if constexpr (Q::loadStoreIndex == IndexIncrement::ByXPlusOne){
+    index += Vx + 1;
+  }
+  else if constexpr (Q::loadStoreIndex == IndexIncrement::ByX){
+    index += Vx;
+  }
 }
+template <typename Q>
 void Chip8::iFx65(){
   //Read registers V0 through Vx from memory starting at location I
   uint8_t Vx = (opcode & VX_MASK) >> 8u;
@@ -506,4 +673,10 @@ void Chip8::iFx65(){
 	{
 		registers[i] = ram[index + i];
 	}
+  if constexpr (Q::loadStoreIndex == IndexIncrement::ByXPlusOne){
+    index += Vx + 1;
+  }
+  else if constexpr (Q::loadStoreIndex == IndexIncrement::ByX){
+    index += Vx;
+  }
 }
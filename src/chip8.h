@@ -6,6 +6,11 @@
 #include <random>
 #include <array>
 #include <map>
+#include <utility>
+#include "opcodes.h"
+#include "quirks.h"
+
+class TraceWriter;
 
 
 const uint16_t PROG_START_ADDR = 0x200;
@@ -20,22 +25,65 @@ const uint8_t DISP_H = 32;
 const uint8_t DISP_W = 64;
 const uint16_t OP_CODE_MASK = 0xF000u;
 const uint16_t OP_CODE_MASK_B = 0x000Fu;
+const uint16_t CYCLES_PER_FRAME = 10;//instructions per 60 Hz frame for headless runs
+
 
+//Copy of everything that determines how a Chip8 runs, used to compare
+//engines and to rewind them.
+struct Chip8State{
+  std::array<uint8_t,4096> ram{};
+  std::array<uint8_t,16> registers{};
+  std::array<uint16_t,16> stack{};
+  uint16_t index{};
+  uint8_t delay{};
+  uint8_t sound{};
+  uint16_t programCounter{};
+  uint8_t stackPointer{};
+  std::array<uint8_t,16> keyboard{};
+  std::array<uint32_t,DISP_W * DISP_H> display{};
 
+  bool operator==(const Chip8State &other) const;
+  bool operator!=(const Chip8State &other) const { return !(*this == other); }
+};
+
+/*Chip8State plus the Cxkk generator, so a restored machine replays the same
+random numbers. Filled in place, a ring of them can be reused every frame
+without building temporaries.*/
+struct Chip8Snapshot{
+  Chip8State state;
+  std::mt19937 generator;
+};
 
 class Chip8{
 
 
 public:
-  Chip8();
+  explicit Chip8(QuirkProfile profile = QuirkProfile::Modern);
   void loadROM(const std::string &file);
-  void cycle();
+  void loadROM(const uint8_t *data, size_t size);
+  void cycle();//step() then tickTimers(), one timer tick per instruction
+  void cycle(TraceWriter &trace);//cycle() and append what it changed to trace
+  void step();//execute one instruction without touching the timers
+  void tickTimers();//one 60 Hz tick of the delay and sound timers
+  void seed(uint32_t value);//make Cxkk repeatable
+  Chip8State save() const;
+  void restore(const Chip8State &state);
+  void save(Chip8Snapshot &snapshot) const;
+  void restore(const Chip8Snapshot &snapshot);
+  //Read only views for tools that inspect a running machine
+  uint16_t getProgramCounter() const { return programCounter; }
+  uint16_t getIndex() const { return index; }
+  uint8_t getStackPointer() const { return stackPointer; }
+  uint8_t getDelay() const { return delay; }
+  uint8_t getSound() const { return sound; }
+  const std::array<uint8_t,16>& getRegisters() const { return registers; }
+  const std::array<uint16_t,16>& getStack() const { return stack; }
+  const std::array<uint8_t,4096>& getRAM() const { return ram; }
   uint8_t keyboard[16]{};//go back and make const
   uint32_t display[DISP_W * DISP_H]{};
   typedef void (Chip8::*MFP)();
   std::map <uint16_t, MFP> opMap;
   std::map <uint16_t, MFP> opMap0;
-  std::map <uint16_t, MFP> opMap8;
   std::map <uint16_t, MFP> opMapE;
   std::map <uint16_t, MFP> opMapF;
 
@@ -54,6 +102,12 @@ private:
   std::random_device device;
   std::mt19937 generator;
   std::uniform_int_distribution<uint8_t> randByte;
+  //Handler for each Op, only needed while the constructor fills the opMap tables
+  typedef std::array<MFP, OP_COUNT> HandlerTable;
+  static MFP& handler(HandlerTable &handlers, Op op){ return handlers[static_cast<size_t>(op)]; }
+  //Points the quirk dependent opcodes at the handlers built for profile Q
+  template <typename Q> void installQuirks(HandlerTable &handlers);
+  void saveInto(Chip8State &state) const;//shared by both save() overloads
   //Opcode functions
   void op0();
   void op8();
@@ -70,20 +124,17 @@ private:
   void i5xy0(); //skip next instruction if Vx=Vy
   void i6xkk(); //(LD Vx, byte)set Vx = kk
   void i7xkk(); //(ADD) set Vx = Vx+kk
-  void i8xy0(); // (LD Vx, Vy) set Vx = Vy
-  void i8xy1(); //(OR Vx, Vy) set Vx = Vx OR Vy
-  void i8xy2(); //(AND Vx, Vy)
-  void i8xy3(); //(XOR)
-  void i8xy4(); //(ADD w/ VF=carry)
-  void i8xy5(); // (SUB) Set Vx=Vx-Vy set VF = NOT borrow.
-  void i8xy6(); //(SHR) Bit shift right
-  void i8xy7(); //(SUBN) Set Vx = Vy - Vx, set VF = NOT borrow.
-  void i8xyE(); //(SHL) bit shift left
+  /*8xyN, (LD OR AND XOR ADD SUB SHR SUBN SHL Vx, Vy) picked by N at compile
+  time. Flags are computed without branches and VF is written after Vx, so
+  with x == F the flag wins. Unassigned N do nothing.*/
+  template <uint8_t N, typename Q> void i8xyN();
+  template <typename Q, size_t... N> static constexpr std::array<MFP,16> aluTable(std::index_sequence<N...>);
+  const MFP *aluHandlers{};//aluTable for the quirk profile, indexed by N
   void i9xy0(); // skip next instruction if Vx!= Vy
   void iAnnn(); // LD Index, addr , The value of index register is set to i1nnn
-  void iBnnn(); // JP V0 addr, jump to nnn+V0
+  template <typename Q> void iBnnn(); // JP V0 addr, jump to nnn+V0
   void iCxkk(); // Set Vx = random byte AND kk.
-  void iDxyn();//Display n-byte sprite starting at memory location I at (Vx, Vy),
+  template <typename Q> void iDxyn();//Display n-byte sprite starting at memory location I at (Vx, Vy),
   //set VF = collision.
   void iEx9E(); //Skip next instruction if key with the value of Vx is pressed.
   void iExA1();//Skip next instruction if key with the value of Vx is not pressed.
@@ -94,8 +145,8 @@ private:
   void iFx1E();//Set I = I + Vx.
   void iFx29();//Set I = location of sprite for digit Vx.
   void iFx33();//Store BCD representation of Vx in memory locations I, I+1, and I+2.
-  void iFx55();//Store registers V0 through Vx in memory starting at location I.
-  void iFx65();/*Read registers V0 through Vx from memory starting at location I.
+  template <typename Q> void iFx55();//Store registers V0 through Vx in memory starting at location I.
+  template <typename Q> void iFx65();/*Read registers V0 through Vx from memory starting at location I.
 
   The interpreter reads values from memory starting at location I
   into registers V0 through Vx.*/
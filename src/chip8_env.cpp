@@ -0,0 +1,103 @@
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include "chip8_env.h"
+#include "vecenv.h"
+
+struct Chip8VecEnv{
+  std::unique_ptr<VecEnv> env;
+};
+
+//No C++ exception may cross the C boundary, failures become NULL or -1
+Chip8VecEnv* chip8_vecenv_create(const char *rom_path, int count, int frames_per_step,
+                                 int profile, int format, int threads){
+  static const QuirkProfile PROFILES[] = {QuirkProfile::CosmacVIP, QuirkProfile::Chip48,
+                                          QuirkProfile::SChip, QuirkProfile::Modern,
+                                          QuirkProfile::XOChip};
+  static const ObservationFormat FORMATS[] = {ObservationFormat::Display, ObservationFormat::Packed,
+                                              ObservationFormat::Bytes};
+  if (count < 1 || frames_per_step < 1 || profile < 0 || profile > 4 || format < 0 || format > 2){
+    return nullptr;
+  }
+  try {
+    std::ifstream file(rom_path, std::ios::binary);
+    if (!file.is_open()){
+      return nullptr;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (threads < 1){
+      threads = std::thread::hardware_concurrency();
+    }
+    return new Chip8VecEnv{std::make_unique<VecEnv>(count, rom, PROFILES[profile], frames_per_step,
+                                                    FORMATS[format], threads)};
+  }
+  catch (const std::exception &){
+    return nullptr;
+  }
+}
+
+void chip8_vecenv_destroy(Chip8VecEnv *env){
+  delete env;
+}
+
+int chip8_vecenv_add_reward(Chip8VecEnv *env, uint16_t address, float scale){
+  try {
+    env->env->addReward({address, scale});
+  }
+  catch (const std::exception &){
+    return -1;
+  }
+  return 0;
+}
+
+int chip8_vecenv_reset(Chip8VecEnv *env){
+  try {
+    env->env->reset();
+  }
+  catch (const std::exception &){
+    return -1;
+  }
+  return 0;
+}
+
+int chip8_vecenv_reset_one(Chip8VecEnv *env, int index){
+  if (index < 0 || static_cast<size_t>(index) >= env->env->size()){
+    return -1;
+  }
+  try {
+    env->env->reset(index);
+  }
+  catch (const std::exception &){
+    return -1;
+  }
+  return 0;
+}
+
+int chip8_vecenv_step(Chip8VecEnv *env, const uint16_t *actions){
+  try {
+    env->env->step(actions);
+  }
+  catch (const std::exception &){
+    return -1;
+  }
+  return 0;
+}
+
+const uint8_t* chip8_vecenv_observations(const Chip8VecEnv *env){
+  return env->env->observations();
+}
+
+const uint32_t* chip8_vecenv_display(const Chip8VecEnv *env, int index){
+  if (index < 0 || static_cast<size_t>(index) >= env->env->size()){
+    return nullptr;
+  }
+  return env->env->observation(index);
+}
+
+int chip8_vecenv_observation_size(const Chip8VecEnv *env){
+  return env->env->observationSize();
+}
+
+const float* chip8_vecenv_rewards(const Chip8VecEnv *env){
+  return env->env->rewards();
+}
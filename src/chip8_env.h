@@ -0,0 +1,40 @@
+#ifndef CHIP8_ENV_H
+#define CHIP8_ENV_H
+
+/*C interface to VecEnv for language bindings, e.g. Python through ctypes.
+Buffers returned here stay valid until the environment is destroyed and are
+rewritten in place by every step and reset, so they can be wrapped once
+(numpy.ctypeslib.as_array) and read without copying.*/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Chip8VecEnv Chip8VecEnv;
+
+/*profile: 0 vip, 1 chip48, 2 schip, 3 modern, 4 xochip.
+format: 0 none, 1 packed 1bpp (256 bytes per machine), 2 one byte per pixel.
+Returns NULL if the ROM can't be read, an argument is out of range or the
+machines or worker threads can't be created.*/
+Chip8VecEnv* chip8_vecenv_create(const char *rom_path, int count, int frames_per_step,
+                                 int profile, int format, int threads);
+void chip8_vecenv_destroy(Chip8VecEnv *env);
+
+//These return 0 on success and -1 on failure, e.g. out of memory
+int chip8_vecenv_add_reward(Chip8VecEnv *env, uint16_t address, float scale);
+int chip8_vecenv_reset(Chip8VecEnv *env);
+int chip8_vecenv_reset_one(Chip8VecEnv *env, int index);
+//actions: one bitmask of pressed keys per machine
+int chip8_vecenv_step(Chip8VecEnv *env, const uint16_t *actions);
+
+const uint8_t* chip8_vecenv_observations(const Chip8VecEnv *env);
+//The machine's own 64x32 framebuffer, one uint32 per pixel, NULL if index is out of range
+const uint32_t* chip8_vecenv_display(const Chip8VecEnv *env, int index);
+int chip8_vecenv_observation_size(const Chip8VecEnv *env);
+const float* chip8_vecenv_rewards(const Chip8VecEnv *env);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
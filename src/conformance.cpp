@@ -0,0 +1,262 @@
+#include <cstdio>
+#include "conformance.h"
+
+//Free RAM above the largest fuzz program that LD I may point at
+const uint16_t FUZZ_DATA_START = 0xA00;
+const uint16_t FUZZ_DATA_END = 0xEF0;
+
+const std::vector<TestROM>& bundledROMs(){
+  static const std::vector<TestROM> roms = {
+    {"alu", {
+      0x6A, 0xFF, //LD VA, 0xFF
+      0x6B, 0x01, //LD VB, 0x01
+      0x8A, 0xB4, //ADD VA, VB (carry)
+      0x6C, 0x05, //LD VC, 0x05
+      0x6D, 0x0A, //LD VD, 0x0A
+      0x8C, 0xD5, //SUB VC, VD (borrow)
+      0x8D, 0xC7, //SUBN VD, VC
+      0x6E, 0x81, //LD VE, 0x81
+      0x8E, 0xD6, //SHR VE, VD
+      0x8E, 0xDE, //SHL VE, VD
+      0x6F, 0x10, //LD VF, 0x10
+      0x6E, 0xF0, //LD VE, 0xF0
+      0x8F, 0xE4, //ADD VF, VE (x == F)
+      0x8A, 0xB1, //OR VA, VB
+      0x8A, 0xB2, //AND VA, VB
+      0x8A, 0xB3, //XOR VA, VB
+      0x80, 0xA0, //LD V0, VA
+      0x70, 0xFF, //ADD V0, 0xFF
+      0x12, 0x00  //JP 0x200
+    }},
+    {"flow", {
+      0x60, 0x01, //200 LD V0, 0x01
+      0x22, 0x10, //202 CALL 0x210
+      0x30, 0x02, //204 SE V0, 0x02
+      0x61, 0xAA, //206 LD V1, 0xAA
+      0x40, 0x02, //208 SNE V0, 0x02
+      0x62, 0xBB, //20A LD V2, 0xBB
+      0x50, 0x10, //20C SE V0, V1
+      0x12, 0x0E, //20E JP 0x20E
+      0x70, 0x01, //210 ADD V0, 0x01
+      0x90, 0x00, //212 SNE V0, V0
+      0x00, 0xEE  //214 RET
+    }},
+    {"memory", {
+      0x60, 0xFE, //LD V0, 0xFE
+      0xA3, 0x00, //LD I, 0x300
+      0xF0, 0x33, //LD B, V0
+      0xF2, 0x65, //LD V2, [I]
+      0xA3, 0x10, //LD I, 0x310
+      0xF2, 0x55, //LD [I], V2
+      0xF1, 0x1E, //ADD I, V1
+      0x63, 0x0A, //LD V3, 0x0A
+      0xF3, 0x29, //LD F, V3
+      0x64, 0x3C, //LD V4, 0x3C
+      0x65, 0x1E, //LD V5, 0x1E
+      0xD4, 0x55, //DRW V4, V5, 5 (crosses the bottom right corner)
+      0xD4, 0x55, //DRW V4, V5, 5 (collision)
+      0x00, 0xE0, //CLS
+      0x12, 0x00  //JP 0x200
+    }},
+    {"timers", {
+      0x60, 0x20, //200 LD V0, 0x20
+      0xF0, 0x15, //202 LD DT, V0
+      0xF0, 0x18, //204 LD ST, V0
+      0xF1, 0x07, //206 LD V1, DT
+      0x66, 0x05, //208 LD V6, 0x05
+      0xE6, 0x9E, //20A SKP V6
+      0x73, 0x01, //20C ADD V3, 0x01
+      0xE6, 0xA1, //20E SKNP V6
+      0x74, 0x01, //210 ADD V4, 0x01
+      0xF4, 0x0A, //212 LD V4, K
+      0xC5, 0x0F, //214 RND V5, 0x0F
+      0x62, 0x20, //216 LD V2, 0x20 (same target for Bnnn and Bxnn)
+      0xB2, 0x20, //218 JP V0, 0x220
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x12, 0x00  //240 JP 0x200
+    }}
+  };
+  return roms;
+}
+
+std::vector<uint8_t> fuzzROM(uint32_t seed, size_t instructions){
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> rom;
+  auto emit = [&rom](uint16_t opcode){
+    rom.push_back(opcode >> 8u);
+    rom.push_back(opcode & 0xFFu);
+  };
+  auto loadIndex = [&](){
+    emit(0xA000 | (FUZZ_DATA_START + rng() % (FUZZ_DATA_END - FUZZ_DATA_START)));
+  };
+  static const uint8_t ALU_OPS[] = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0xE};
+  static const uint8_t TIMER_OPS[] = {0x07, 0x0A, 0x15, 0x18, 0x29};
+  static const uint8_t MEMORY_OPS[] = {0x33, 0x55, 0x65};
+  //Fx1E is left out, repeated adds would walk I off the end of RAM
+
+  for (size_t i = 0; i < instructions; ++i){
+    uint16_t x = (rng() % 16) << 8u;
+    uint16_t y = (rng() % 16) << 4u;
+    uint16_t kk = rng() % 256;
+    switch (rng() % 12){
+      case 0: emit(0x3000 | x | kk); break;
+      case 1: emit(0x4000 | x | kk); break;
+      case 2: emit(0x5000 | x | y); break;
+      case 3: emit(0x6000 | x | kk); break;
+      case 4: emit(0x7000 | x | kk); break;
+      case 5: emit(0x8000 | x | y | ALU_OPS[rng() % 9]); break;
+      case 6: emit(0x9000 | x | y); break;
+      case 7: emit(0xC000 | x | kk); break;
+      case 8: emit(0xE000 | x | (rng() % 2 ? 0x9E : 0xA1)); break;
+      case 9: {
+        uint8_t op = TIMER_OPS[rng() % 5];
+        emit(0xF000 | x | op);
+        if (op == 0x29){
+          loadIndex();//LD F can point I back into the program
+        }
+      } break;
+      case 10:
+        //A skipped fence still leaves I at an earlier fence plus at most 16
+        loadIndex();
+        emit(0xF000 | x | MEMORY_OPS[rng() % 3]);
+        loadIndex();
+        break;
+      case 11:
+        loadIndex();
+        emit(rng() % 8 ? (0xD000 | x | y | (rng() % 16)) : 0x00E0);
+        loadIndex();
+        break;
+    }
+  }
+  //Twice, in case the last instruction skips the first one
+  emit(0x1000 | PROG_START_ADDR);
+  emit(0x1000 | PROG_START_ADDR);
+  return rom;
+}
+
+//Operand values for checkALU, dense around the carry, borrow and sign edges
+const uint8_t ALU_VALUES[] = {0x00, 0x01, 0x02, 0x0F, 0x10, 0x3C, 0x55, 0x7E,
+                              0x7F, 0x80, 0x81, 0xAA, 0xC3, 0xF0, 0xFE, 0xFF};
+
+//8xyN applied to registers as the spec reads: Vx is written first and VF
+//last, so with x == F the flag is what remains.
+template <typename Q>
+void aluModel(uint8_t n, uint8_t x, uint8_t y, std::array<uint8_t,16> &registers){
+  unsigned a = registers[x];
+  unsigned b = registers[y];
+  unsigned source = Q::shiftUsesVy ? b : a;
+  switch (n){
+    case 0x0: registers[x] = b; break;
+    case 0x1: registers[x] = a | b; break;
+    case 0x2: registers[x] = a & b; break;
+    case 0x3: registers[x] = a ^ b; break;
+    case 0x4: registers[x] = a + b; registers[0xF] = a + b > 0xFF; break;
+    case 0x5: registers[x] = a - b; registers[0xF] = a >= b; break;
+    case 0x6: registers[x] = source >> 1; registers[0xF] = source & 1; break;
+    case 0x7: registers[x] = b - a; registers[0xF] = b >= a; break;
+    case 0xE: registers[x] = source << 1; registers[0xF] = source >> 7; break;
+    default: return;//unassigned, nothing happens
+  }
+  if (n >= 0x1 && n <= 0x3 && Q::logicResetsVF){
+    registers[0xF] = 0;
+  }
+}
+
+template <typename Q>
+Divergence checkALUWith(QuirkProfile profile){
+  Chip8 chip8(profile);
+  Divergence result;
+  for (uint8_t n = 0; n < 16; ++n){
+    for (uint8_t x = 0; x < 16; ++x){
+      for (uint8_t y = 0; y < 16; ++y){
+        for (uint8_t a : ALU_VALUES){
+          for (uint8_t b : ALU_VALUES){
+            //LD Vx, a  LD Vy, b  8xyN  JP 0x200, reloaded for every case
+            const uint8_t rom[] = {static_cast<uint8_t>(0x60 | x), a, static_cast<uint8_t>(0x60 | y), b,
+                                   static_cast<uint8_t>(0x80 | x), static_cast<uint8_t>(y << 4u | n), 0x12, 0x00};
+            chip8.loadROM(rom, sizeof(rom));
+            chip8.cycle();
+            chip8.cycle();
+            std::array<uint8_t,16> expected = chip8.getRegisters();
+            aluModel<Q>(n, x, y, expected);
+            chip8.cycle();
+            const std::array<uint8_t,16> &actual = chip8.getRegisters();
+            if (actual != expected){
+              char line[64];
+              snprintf(line, sizeof(line), "8%X%X%X with V%X=%02X V%X=%02X\n", x, y, n, x, a, y, b);
+              result.report = line;
+              for (int i = 0; i < 16; ++i){
+                if (expected[i] != actual[i]){
+                  snprintf(line, sizeof(line), "  V%X expected %02X got %02X\n", i, expected[i], actual[i]);
+                  result.report += line;
+                }
+              }
+              result.found = true;
+              return result;
+            }
+            chip8.cycle();
+            ++result.step;
+          }
+        }
+      }
+    }
+  }
+  return result;
+}
+
+Divergence checkALU(QuirkProfile profile){
+  switch (profile){
+    case QuirkProfile::CosmacVIP: return checkALUWith<CosmacVIPQuirks>(profile);
+    case QuirkProfile::Chip48: return checkALUWith<Chip48Quirks>(profile);
+    case QuirkProfile::SChip: return checkALUWith<SChipQuirks>(profile);
+    case QuirkProfile::Modern: return checkALUWith<ModernQuirks>(profile);
+    case QuirkProfile::XOChip: return checkALUWith<XOChipQuirks>(profile);
+  }
+  return {};
+}
+
+std::string describeDifference(const Chip8State &expected, const Chip8State &actual){
+  std::ostringstream report;
+  char line[64];
+  if (expected.programCounter != actual.programCounter){
+    snprintf(line, sizeof(line), "  PC expected %03X got %03X\n", expected.programCounter, actual.programCounter);
+    report << line;
+  }
+  if (expected.index != actual.index){
+    snprintf(line, sizeof(line), "  I expected %03X got %03X\n", expected.index, actual.index);
+    report << line;
+  }
+  for (int i = 0; i < 16; ++i){
+    if (expected.registers[i] != actual.registers[i]){
+      snprintf(line, sizeof(line), "  V%X expected %02X got %02X\n", i, expected.registers[i], actual.registers[i]);
+      report << line;
+    }
+  }
+  if (expected.stackPointer != actual.stackPointer || expected.stack != actual.stack){
+    snprintf(line, sizeof(line), "  stack differs, SP expected %u got %u\n", expected.stackPointer, actual.stackPointer);
+    report << line;
+  }
+  if (expected.delay != actual.delay || expected.sound != actual.sound){
+    snprintf(line, sizeof(line), "  timers expected DT=%u ST=%u got DT=%u ST=%u\n",
+             expected.delay, expected.sound, actual.delay, actual.sound);
+    report << line;
+  }
+  for (size_t i = 0; i < expected.ram.size(); ++i){
+    if (expected.ram[i] != actual.ram[i]){
+      snprintf(line, sizeof(line), "  RAM[%03zX] expected %02X got %02X\n", i, expected.ram[i], actual.ram[i]);
+      report << line;
+    }
+  }
+  int pixels = 0;
+  for (size_t i = 0; i < expected.display.size(); ++i){
+    pixels += expected.display[i] != actual.display[i];
+  }
+  if (pixels){
+    report << "  " << pixels << " display pixels differ\n";
+  }
+  return report.str();
+}
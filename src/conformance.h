@@ -0,0 +1,95 @@
+#ifndef CONFORMANCE_H
+#define CONFORMANCE_H
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "chip8.h"
+#include "disasm.h"
+
+const size_t TRACE_DEPTH = 16;
+
+//Small hand assembled ROM that exercises one group of opcodes.
+struct TestROM{
+  const char *name;
+  std::vector<uint8_t> bytes;
+};
+
+struct Divergence{
+  bool found{};
+  long step{};
+  std::string report;
+};
+
+const std::vector<TestROM>& bundledROMs();
+
+//Random straight line program that can't run the reference out of bounds:
+//no control flow besides skips and a final jump back to the start, and every
+//memory access is fenced by LD I loads that keep I inside free RAM.
+std::vector<uint8_t> fuzzROM(uint32_t seed, size_t instructions);
+
+/*Runs every 8xyN, for every x and y and operand values around the carry and
+borrow edges, and checks Vx and VF against a model written from the spec.
+Unassigned N must leave the registers alone.*/
+Divergence checkALU(QuirkProfile profile);
+
+//Human readable list of the fields that differ between two states.
+std::string describeDifference(const Chip8State &expected, const Chip8State &actual);
+
+/*Runs the reference interpreter and a candidate engine in lock step on the
+same ROM, RNG seed and keyboard input, comparing full state after every
+instruction. Engine needs the Chip8 interface used here: a QuirkProfile
+constructor, loadROM, seed, cycle, save and the keyboard array.*/
+template <typename Engine>
+Divergence runDifferential(QuirkProfile profile, const std::vector<uint8_t> &rom, long steps, uint32_t seed){
+  Chip8 reference(profile);
+  Engine candidate(profile);
+  reference.loadROM(rom.data(), rom.size());
+  candidate.loadROM(rom.data(), rom.size());
+  reference.seed(seed);
+  candidate.seed(seed);
+
+  std::mt19937 input(seed);
+  std::deque<std::pair<uint16_t, uint16_t>> trace;
+  Chip8State expected = reference.save();
+  Divergence result;
+
+  for (long step = 0; step < steps; ++step){
+    //Toggle a key now and then so Ex9E, ExA1 and Fx0A see both states
+    if (input() % 64 == 0){
+      uint8_t key = input() % 16;
+      reference.keyboard[key] ^= 1;
+      candidate.keyboard[key] ^= 1;
+    }
+    uint16_t pc = expected.programCounter;
+    trace.emplace_back(pc, (expected.ram[pc] << 8u) | expected.ram[pc + 1]);
+    if (trace.size() > TRACE_DEPTH){
+      trace.pop_front();
+    }
+
+    reference.cycle();
+    candidate.cycle();
+    expected = reference.save();
+    Chip8State actual = candidate.save();
+
+    if (expected != actual){
+      std::ostringstream report;
+      report << "diverged after instruction " << step << "\n";
+      for (auto &entry : trace){
+        char line[16];
+        snprintf(line, sizeof(line), "  %03X  %04X  ", entry.first, entry.second);
+        report << line << disassemble(entry.second) << "\n";
+      }
+      report << describeDifference(expected, actual);
+      result.found = true;
+      result.step = step;
+      result.report = report.str();
+      return result;
+    }
+  }
+  return result;
+}
+#endif
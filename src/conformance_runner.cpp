@@ -0,0 +1,57 @@
+#include "chip8.h"
+#include "conformance.h"
+#include "simple_chip8.h"
+
+#include <iostream>
+#include <string>
+
+const QuirkProfile PROFILES[] = {QuirkProfile::CosmacVIP, QuirkProfile::Chip48,
+                                 QuirkProfile::SChip, QuirkProfile::Modern, QuirkProfile::XOChip};
+
+//Runs every bundled ROM and fuzzRuns random programs against Engine under
+//every quirk profile, printing the first divergence of each run.
+template <typename Engine>
+int runSuite(const char *engineName, int fuzzRuns, long steps){
+  int failures = 0;
+  auto check = [&](QuirkProfile profile, const std::string &romName, const std::vector<uint8_t> &rom, uint32_t seed){
+    Divergence divergence = runDifferential<Engine>(profile, rom, steps, seed);
+    if (divergence.found){
+      ++failures;
+      std::cout << engineName << " " << quirkProfileName(profile) << " " << romName << ": "
+                << divergence.report << std::endl;
+    }
+  };
+
+  for (QuirkProfile profile : PROFILES){
+    for (const TestROM &rom : bundledROMs()){
+      check(profile, rom.name, rom.bytes, 1);
+    }
+    for (int run = 0; run < fuzzRuns; ++run){
+      check(profile, "fuzz seed " + std::to_string(run), fuzzROM(run, 256), run);
+    }
+  }
+  std::cout << engineName << ": " << failures << " divergences" << std::endl;
+  return failures;
+}
+
+//Exits non-zero when any engine disagrees with the reference interpreter.
+int main(int argc, char **argv){
+  if (argc > 3){
+    std::cerr << "Usage: " << argv[0] << " [FuzzRuns] [Steps]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  int fuzzRuns = argc > 1 ? std::stoi(argv[1]) : 50;
+  long steps = argc > 2 ? std::stol(argv[2]) : 5000;
+
+  int failures = 0;
+  for (QuirkProfile profile : PROFILES){
+    Divergence divergence = checkALU(profile);
+    if (divergence.found){
+      ++failures;
+      std::cout << "alu model " << quirkProfileName(profile) << ": " << divergence.report;
+    }
+  }
+  std::cout << "alu model: " << failures << " mismatches" << std::endl;
+  failures += runSuite<SimpleChip8>("simple", fuzzRuns, steps);
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+#include "chip8.h"
+#include "debugger.h"
+#include "quirks.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+//Serves the debugger REPL to one local client at a time until one quits.
+int serve(Debugger &debugger, int port){
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  if (listener < 0){
+    std::cerr << "Could not create a socket" << std::endl;
+    return EXIT_FAILURE;
+  }
+  int reuse = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);//never expose the machine off host
+  if (bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(listener, 1) < 0){
+    std::cerr << "Could not listen on 127.0.0.1:" << port << std::endl;
+    close(listener);
+    return EXIT_FAILURE;
+  }
+  std::cout << "Listening on 127.0.0.1:" << port << std::endl;
+
+  bool running = true;
+  while (running){
+    int client = accept(listener, nullptr, nullptr);
+    if (client < 0){
+      continue;
+    }
+    std::string pending;
+    char buffer[512];
+    ssize_t received;
+    bool connected = true;
+    while (running && connected && (received = recv(client, buffer, sizeof(buffer), 0)) > 0){
+      pending.append(buffer, received);
+      size_t newline;
+      while (running && connected && (newline = pending.find('\n')) != std::string::npos){
+        std::ostringstream reply;
+        running = debugger.execute(pending.substr(0, newline), reply);
+        pending.erase(0, newline + 1);
+        std::string text = reply.str();
+        //A client that hung up mid reply must not take the debugger down with SIGPIPE
+        connected = send(client, text.data(), text.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(text.size());
+      }
+    }
+    close(client);
+  }
+  close(listener);
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv){
+  if (argc != 3 && argc != 4){
+    std::cerr << "Usage: " << argv[0] << " <ROM> <vip|chip48|schip|modern|xochip> [Port]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  QuirkProfile profile;
+  if (!parseQuirkProfile(argv[2], profile)){
+    std::cerr << "Unknown quirk profile " << argv[2] << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  Chip8 chip8(profile);
+  chip8.loadROM(argv[1]);
+  Debugger debugger(chip8);
+
+  if (argc == 4){
+    return serve(debugger, std::stoi(argv[3]));
+  }
+
+  std::string line;
+  std::cout << "> " << std::flush;
+  while (std::getline(std::cin, line) && debugger.execute(line, std::cout)){
+    std::cout << "> " << std::flush;
+  }
+  return EXIT_SUCCESS;
+}
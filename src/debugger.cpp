@@ -0,0 +1,239 @@
+#include <cstdio>
+#include <sstream>
+#include "debugger.h"
+#include "disasm.h"
+#include "opcodes.h"
+
+void Debugger::setWatchpoint(uint16_t address, uint16_t length, bool on){
+  for (uint16_t i = 0; i < length; ++i){
+    watchpoints[(address + i) & NNN_MASK] = on;
+  }
+}
+
+void Debugger::addCondition(const RegisterCondition &condition){
+  conditions.push_back(condition);
+  conditionWasTrue.assign(conditions.size(), false);
+}
+
+void Debugger::clearConditions(){
+  conditions.clear();
+  conditionWasTrue.clear();
+}
+
+bool Debugger::conditionBecameTrue(){
+  const std::array<uint8_t,16> &registers = chip8.getRegisters();
+  bool stop = false;
+  for (size_t i = 0; i < conditions.size(); ++i){
+    const RegisterCondition &condition = conditions[i];
+    uint8_t value = registers[condition.reg];
+    bool holds = false;
+    switch (condition.comparison){
+      case '=': holds = value == condition.value; break;
+      case '!': holds = value != condition.value; break;
+      case '<': holds = value < condition.value; break;
+      case '>': holds = value > condition.value; break;
+    }
+    //Every condition is updated, even after one has already asked to stop
+    stop = stop || (holds && !conditionWasTrue[i]);
+    conditionWasTrue[i] = holds;
+  }
+  return stop;
+}
+
+StopReason Debugger::executeOne(){
+  const std::array<uint8_t,4096> &ram = chip8.getRAM();
+  uint16_t pc = chip8.getProgramCounter();
+  uint16_t opcode = (ram[pc] << 8u) | ram[pc + 1];
+  uint16_t address = chip8.getIndex();
+  bool watched = false;
+  for (uint16_t i = 0; i < ramWriteLength(opcode); ++i){
+    if (watchpoints[(address + i) & NNN_MASK]){
+      watched = true;
+      lastWrite = (address + i) & NNN_MASK;
+      break;
+    }
+  }
+  chip8.cycle();
+  if (watched){
+    return StopReason::Watchpoint;
+  }
+  if (!conditions.empty() && conditionBecameTrue()){
+    return StopReason::Condition;
+  }
+  return StopReason::Step;
+}
+
+StopReason Debugger::step(){
+  return executeOne();
+}
+
+StopReason Debugger::run(long limit){
+  for (long i = 0; i < limit; ++i){
+    //A breakpoint on the instruction we are resuming from doesn't stop us
+    if (i > 0 && breakpoints[chip8.getProgramCounter() & NNN_MASK]){
+      return StopReason::Breakpoint;
+    }
+    StopReason reason = executeOne();
+    if (reason != StopReason::Step){
+      return reason;
+    }
+  }
+  return StopReason::Limit;
+}
+
+StopReason Debugger::stepOver(long limit){
+  const std::array<uint8_t,4096> &ram = chip8.getRAM();
+  uint16_t pc = chip8.getProgramCounter();
+  if ((ram[pc] & 0xF0u) != 0x20u){
+    return executeOne();
+  }
+  //Run the whole subroutine, until it returns to this call depth
+  uint16_t returnAddress = pc + 2;
+  uint8_t depth = chip8.getStackPointer();
+  StopReason reason = executeOne();
+  for (long i = 1; i < limit && reason == StopReason::Step; ++i){
+    pc = chip8.getProgramCounter();
+    if (pc == returnAddress && chip8.getStackPointer() == depth){
+      return StopReason::Step;
+    }
+    if (breakpoints[pc & NNN_MASK]){
+      return StopReason::Breakpoint;
+    }
+    reason = executeOne();
+  }
+  return reason == StopReason::Step ? StopReason::Limit : reason;
+}
+
+void Debugger::printRegisters(std::ostream &out) const{
+  char line[64];
+  const std::array<uint8_t,16> &registers = chip8.getRegisters();
+  for (int i = 0; i < 16; ++i){
+    snprintf(line, sizeof(line), "V%X=%02X%s", i, registers[i], i % 8 == 7 ? "\n" : " ");
+    out << line;
+  }
+  snprintf(line, sizeof(line), "PC=%03X I=%03X SP=%u DT=%u ST=%u\n", chip8.getProgramCounter(),
+           chip8.getIndex(), chip8.getStackPointer(), chip8.getDelay(), chip8.getSound());
+  out << line;
+}
+
+void Debugger::printStop(StopReason reason, std::ostream &out) const{
+  char line[64];
+  switch (reason){
+    case StopReason::Breakpoint: out << "breakpoint\n"; break;
+    case StopReason::Condition: out << "register condition\n"; break;
+    case StopReason::Limit: out << "instruction limit\n"; break;
+    case StopReason::Watchpoint:
+      snprintf(line, sizeof(line), "watchpoint, RAM[%03X]=%02X\n", lastWrite, chip8.getRAM()[lastWrite]);
+      out << line;
+      break;
+    case StopReason::Step: break;
+  }
+  const std::array<uint8_t,4096> &ram = chip8.getRAM();
+  uint16_t pc = chip8.getProgramCounter();
+  uint16_t opcode = (ram[pc] << 8u) | ram[pc + 1];
+  snprintf(line, sizeof(line), "%03X  %04X  ", pc, opcode);
+  out << line << disassemble(opcode) << "\n";
+}
+
+bool Debugger::execute(const std::string &line, std::ostream &out){
+  std::istringstream words(line);
+  std::string command;
+  if (!(words >> command)){
+    return true;
+  }
+  //Addresses and values are hex, counts are decimal
+  auto hexArg = [&words](unsigned fallback){
+    std::string word;
+    return words >> word ? static_cast<unsigned>(std::stoul(word, nullptr, 16)) : fallback;
+  };
+  auto countArg = [&words](long fallback){
+    long count;
+    return words >> count ? count : fallback;
+  };
+
+  try {
+    if (command == "q" || command == "quit"){
+      return false;
+    }
+    else if (command == "s" || command == "step"){
+      printStop(step(), out);
+    }
+    else if (command == "n" || command == "next"){
+      printStop(stepOver(countArg(1000000)), out);
+    }
+    else if (command == "c" || command == "continue"){
+      printStop(run(countArg(1000000)), out);
+    }
+    else if (command == "b" || command == "break"){
+      setBreakpoint(hexArg(chip8.getProgramCounter()), true);
+    }
+    else if (command == "d" || command == "delete"){
+      setBreakpoint(hexArg(chip8.getProgramCounter()), false);
+    }
+    else if (command == "w" || command == "watch"){
+      uint16_t address = hexArg(chip8.getIndex());
+      setWatchpoint(address, countArg(1), true);
+    }
+    else if (command == "unwatch"){
+      uint16_t address = hexArg(chip8.getIndex());
+      setWatchpoint(address, countArg(1), false);
+    }
+    else if (command == "cond"){
+      //cond 3 = 1F stops once V3 == 0x1F
+      std::string comparison;
+      unsigned reg = hexArg(16);
+      words >> comparison;
+      unsigned value = hexArg(256);
+      if (reg > 15 || value > 255 || comparison.size() != 1 || std::string("=!<>").find(comparison) == std::string::npos){
+        out << "usage: cond <reg> <=|!|<|>> <value>\n";
+      }
+      else {
+        addCondition({static_cast<uint8_t>(reg), comparison[0], static_cast<uint8_t>(value)});
+      }
+    }
+    else if (command == "uncond"){
+      clearConditions();
+    }
+    else if (command == "key"){
+      unsigned key = hexArg(0) & 0xFu;
+      chip8.keyboard[key] = countArg(1) != 0;
+    }
+    else if (command == "r" || command == "regs"){
+      printRegisters(out);
+    }
+    else if (command == "x"){
+      const std::array<uint8_t,4096> &ram = chip8.getRAM();
+      uint16_t address = hexArg(chip8.getIndex()) & NNN_MASK;
+      long count = countArg(16);
+      char text[16];
+      for (long i = 0; i < count && address + i < 4096; ++i){
+        if (i % 16 == 0){
+          snprintf(text, sizeof(text), "%s%03lX ", i ? "\n" : "", address + i);
+          out << text;
+        }
+        snprintf(text, sizeof(text), " %02X", ram[address + i]);
+        out << text;
+      }
+      out << "\n";
+    }
+    else if (command == "dis"){
+      const std::array<uint8_t,4096> &ram = chip8.getRAM();
+      uint16_t address = hexArg(chip8.getProgramCounter()) & NNN_MASK;
+      long count = countArg(8);
+      char text[16];
+      for (long i = 0; i < count && address + 1 < 4096; ++i, address += 2){
+        uint16_t opcode = (ram[address] << 8u) | ram[address + 1];
+        snprintf(text, sizeof(text), "%c%03X  %04X  ", breakpoints[address] ? '*' : ' ', address, opcode);
+        out << text << disassemble(opcode) << "\n";
+      }
+    }
+    else {
+      out << "commands: s, n [limit], c [limit], b/d [addr], w/unwatch [addr] [len],\n"
+             "  cond <reg> <op> <value>, uncond, key <k> [0|1], r, x [addr] [len], dis [addr] [n], q\n";
+    }
+  }
+  catch (const std::exception &){
+    out << "bad argument\n";
+  }
+  return true;
+}
@@ -0,0 +1,63 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <bitset>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "chip8.h"
+
+enum class StopReason{
+  Step,
+  Breakpoint,
+  Watchpoint,
+  Condition,
+  Limit
+};
+
+//Stop when the comparison of register Vx against value becomes true
+struct RegisterCondition{
+  uint8_t reg;
+  char comparison;//one of = ! < >
+  uint8_t value;
+};
+
+/*Drives a Chip8 one instruction at a time and checks breakpoints between
+instructions. Chip8::cycle() itself never looks at any of this, so a
+machine that isn't being debugged pays nothing. PC breakpoints and RAM
+watchpoints are bitmaps over the address space; watchpoints are checked
+only for Fx33 and Fx55, the instructions that write RAM.*/
+class Debugger{
+public:
+  explicit Debugger(Chip8 &chip8) : chip8(chip8) {}
+
+  void setBreakpoint(uint16_t address, bool on){ breakpoints[address & NNN_MASK] = on; }
+  void setWatchpoint(uint16_t address, uint16_t length, bool on);
+  //Conditions stop once when they turn true, not on every instruction while
+  //they stay true. Adding or clearing conditions re-arms all of them.
+  void addCondition(const RegisterCondition &condition);
+  void clearConditions();
+
+  StopReason step();
+  StopReason stepOver(long limit);
+  StopReason run(long limit);
+
+  //Runs one REPL command, writing the reply to out. False once the user quits.
+  bool execute(const std::string &line, std::ostream &out);
+
+private:
+  //Executes one instruction, reporting whether it hit a watchpoint or condition
+  StopReason executeOne();
+  bool conditionBecameTrue();
+  void printRegisters(std::ostream &out) const;
+  void printStop(StopReason reason, std::ostream &out) const;
+
+  Chip8 &chip8;
+  std::bitset<4096> breakpoints;
+  std::bitset<4096> watchpoints;
+  std::vector<RegisterCondition> conditions;
+  std::vector<bool> conditionWasTrue;//each condition after the last instruction
+  uint16_t lastWrite{};
+};
+#endif
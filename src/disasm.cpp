@@ -0,0 +1,45 @@
+#include <cstdio>
+#include "chip8.h"
+#include "disasm.h"
+#include "opcodes.h"
+
+std::string disassemble(uint16_t opcode){
+  char text[32];
+  const OpInfo *info = decode(opcode);
+  if (!info){
+    snprintf(text, sizeof(text), "DW 0x%04X", opcode);
+    return text;
+  }
+
+  //Expand the operand placeholders in the shared decode table's format
+  std::string result;
+  for (const char *c = info->format; *c; ++c){
+    if (*c != '{'){
+      result += *c;
+      continue;
+    }
+    const char *close = c;
+    while (*close != '}'){
+      ++close;
+    }
+    std::string field(c + 1, close);
+    if (field == "x"){
+      snprintf(text, sizeof(text), "%X", (opcode & VX_MASK) >> 8u);
+    }
+    else if (field == "y"){
+      snprintf(text, sizeof(text), "%X", (opcode & 0x00F0u) >> 4u);
+    }
+    else if (field == "n"){
+      snprintf(text, sizeof(text), "%u", opcode & N_MASK);
+    }
+    else if (field == "kk"){
+      snprintf(text, sizeof(text), "0x%02X", opcode & KK_MASK);
+    }
+    else {
+      snprintf(text, sizeof(text), "0x%03X", opcode & NNN_MASK);
+    }
+    result += text;
+    c = close;
+  }
+  return result;
+}
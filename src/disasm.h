@@ -0,0 +1,11 @@
+#ifndef DISASM_H
+#define DISASM_H
+
+#include <cstdint>
+#include <string>
+
+//Cowgod style mnemonic for one opcode, e.g. "ADD V3, V4", decoded through
+//the same table Chip8 dispatches on. Opcodes Chip8 ignores come back as
+//"DW 0xXXXX".
+std::string disassemble(uint16_t opcode);
+#endif
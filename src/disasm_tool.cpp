@@ -0,0 +1,77 @@
+#include "analysis.h"
+#include "chip8.h"
+#include "disasm.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+//Prints a ROM as labelled basic blocks and data without running it.
+int main(int argc, char **argv){
+  if (argc != 2){
+    std::cerr << "Usage: " << argv[0] << " <ROM>" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file.is_open()){
+    std::cerr << "Could not open " << argv[1] << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  ROMAnalysis analysis = analyzeROM(rom.data(), rom.size());
+
+  uint16_t romEnd = PROG_START_ADDR + rom.size();
+  char line[64];
+  uint16_t addr = PROG_START_ADDR;
+  while (addr < romEnd){
+    const BasicBlock *block = analysis.blockAt(addr);
+    if (block){
+      snprintf(line, sizeof(line), "\nL%03X:", block->start);
+      std::cout << line;
+      if (!block->successors.empty() || block->dynamicExit){
+        std::cout << "  ; ->";
+      }
+      for (uint16_t successor : block->successors){
+        snprintf(line, sizeof(line), " L%03X", successor);
+        std::cout << line;
+      }
+      if (block->dynamicExit){
+        std::cout << " ?";
+      }
+      std::cout << "\n";
+      for (uint16_t pc = block->start; pc < block->end; pc += 2){
+        uint16_t opcode = (rom[pc - PROG_START_ADDR] << 8u) | rom[pc + 1 - PROG_START_ADDR];
+        snprintf(line, sizeof(line), "  %03X  %04X  ", pc, opcode);
+        std::cout << line << disassemble(opcode);
+        if ((analysis.bytes[pc] | analysis.bytes[pc + 1]) & BYTE_WRITTEN){
+          std::cout << "  ; overwritten at run time";
+        }
+        std::cout << "\n";
+      }
+      addr = block->end;
+      continue;
+    }
+    if (analysis.bytes[addr] & BYTE_CODE){
+      //Middle of an instruction reached from an odd address
+      ++addr;
+      continue;
+    }
+    //Run of data, eight bytes per line
+    snprintf(line, sizeof(line), "  %03X  DB", addr);
+    std::cout << line;
+    bool sprite = false;
+    for (int i = 0; i < 8 && addr < romEnd && !(analysis.bytes[addr] & BYTE_CODE); ++i, ++addr){
+      snprintf(line, sizeof(line), " %02X", rom[addr - PROG_START_ADDR]);
+      std::cout << line;
+      sprite |= (analysis.bytes[addr] & BYTE_SPRITE) != 0;
+    }
+    std::cout << (sprite ? "  ; sprite\n" : "\n");
+  }
+
+  if (!analysis.selfModifying.empty()){
+    std::cout << "\n; " << analysis.selfModifying.size() << " code bytes may be overwritten" << std::endl;
+  }
+  return 0;
+}
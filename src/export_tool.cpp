@@ -0,0 +1,61 @@
+#include "capture.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+//Turns a capture stream into a Y4M video or one PNG per distinct frame.
+int main(int argc, char **argv){
+  if (argc != 4 && argc != 5){
+    std::cerr << "Usage: " << argv[0] << " <Capture> y4m <Output.y4m> [Scale]\n"
+              << "       " << argv[0] << " <Capture> png <Prefix> [Scale]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::string format = argv[2];
+  std::string output = argv[3];
+  int scale = argc == 5 ? std::stoi(argv[4]) : 1;
+  if (scale < 1 || (format != "y4m" && format != "png")){
+    std::cerr << "Unknown format or scale" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  FrameReader capture(argv[1]);
+  if (!capture.isOpen()){
+    std::cerr << argv[1] << " is not a capture file" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  std::ofstream video;
+  if (format == "y4m"){
+    video.open(output, std::ios::binary);
+    if (!writeY4MHeader(video, scale)){
+      std::cerr << "Could not write " << output << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+
+  PackedFrame frame;
+  uint32_t repeats;
+  uint64_t frameNumber = 0;
+  while (capture.next(frame, repeats)){
+    if (format == "y4m"){
+      //Y4M is constant rate, so held frames are written out again
+      for (uint32_t i = 0; i < repeats; ++i){
+        writeY4MFrame(video, frame, scale);
+      }
+    }
+    else {
+      //Files are named after the 60 Hz frame the image first appeared on
+      char suffix[32];
+      snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(frameNumber));
+      if (!writePNG(output + suffix, frame, scale)){
+        std::cerr << "Could not write " << output + suffix << std::endl;
+        std::exit(EXIT_FAILURE);
+      }
+    }
+    frameNumber += repeats;
+  }
+  std::cout << frameNumber << " frames exported" << std::endl;
+  return EXIT_SUCCESS;
+}
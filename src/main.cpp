@@ -1,23 +1,41 @@
 #include "chip8.h"
 #include "platform.h"
+#include "timing.h"
 
 #include <chrono>
 #include <iostream>
+#include <string>
 
+//One instruction runs every Delay milliseconds. With --timed the VIP timing
+//model runs one frame of work every 1/60 s instead and Delay is ignored.
 int main(int argc, char **argv){
-  if (argc != 4){
-    std::cerr << "Usage: " << argv[0] << " <Scale> <Delay> <ROM>" << std::endl;
+  const char *program = argv[0];
+  bool timed = argc > 1 && std::string(argv[1]) == "--timed";
+  if (timed){
+    --argc;
+    ++argv;
+  }
+  if (argc != 4 && argc != 5){
+    std::cerr << "Usage: " << program << " [--timed] <Scale> <Delay> <ROM> [vip|chip48|schip|modern|xochip]" << std::endl;
     std::exit(EXIT_FAILURE);
   }
   int displayScale = std::stoi(argv[1]);
 	int cycleDelay = std::stoi(argv[2]);
 	char const* romFilename = argv[3];
+  QuirkProfile profile = QuirkProfile::Modern;
+  if (argc == 5 && !parseQuirkProfile(argv[4], profile)){
+    std::cerr << "Unknown quirk profile " << argv[4] << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
 
   Platform platform("CHIP-8 Emulator", DISP_W * displayScale, DISP_H * displayScale, DISP_W, DISP_H);
 
-  Chip8 chip8;
+  Chip8 chip8(profile);
   chip8.loadROM(romFilename);
 
+  FrameScheduler scheduler(chip8);
+  const float frameDelay = 1000.0f / 60;
+
   int displayPitch = sizeof(chip8.display[0])*DISP_W;
   auto lastCycleTime = std::chrono::high_resolution_clock::now();
   bool quit = false;
@@ -26,7 +44,14 @@ int main(int argc, char **argv){
     quit = platform.ProcessInput(chip8.keyboard);
     auto currentTime = std::chrono::high_resolution_clock::now();
     float delta = std::chrono::duration<float, std::chrono::milliseconds::period>(currentTime - lastCycleTime).count();
-    if (delta > cycleDelay){
+    if (timed){
+      if (delta >= frameDelay){
+        lastCycleTime = currentTime;
+        scheduler.runFrame();
+        platform.Update(chip8.display, displayPitch);
+      }
+    }
+    else if (delta > cycleDelay){
       lastCycleTime = currentTime;
       chip8.cycle();
       platform.Update(chip8.display, displayPitch);
@@ -0,0 +1,72 @@
+#include "chip8.h"
+#include "opcodes.h"
+
+const OpInfo OP_TABLE[OP_COUNT] = {
+  {0x0000, 0x0, Op::CLS, "CLS"},
+  {0x0000, 0xE, Op::RET, "RET"},
+  {0x1000, 0x0, Op::JP, "JP {nnn}"},
+  {0x2000, 0x0, Op::CALL, "CALL {nnn}"},
+  {0x3000, 0x0, Op::SE_BYTE, "SE V{x}, {kk}"},
+  {0x4000, 0x0, Op::SNE_BYTE, "SNE V{x}, {kk}"},
+  {0x5000, 0x0, Op::SE_REG, "SE V{x}, V{y}"},
+  {0x6000, 0x0, Op::LD_BYTE, "LD V{x}, {kk}"},
+  {0x7000, 0x0, Op::ADD_BYTE, "ADD V{x}, {kk}"},
+  {0x8000, 0x0, Op::LD_REG, "LD V{x}, V{y}"},
+  {0x8000, 0x1, Op::OR, "OR V{x}, V{y}"},
+  {0x8000, 0x2, Op::AND, "AND V{x}, V{y}"},
+  {0x8000, 0x3, Op::XOR, "XOR V{x}, V{y}"},
+  {0x8000, 0x4, Op::ADD_REG, "ADD V{x}, V{y}"},
+  {0x8000, 0x5, Op::SUB, "SUB V{x}, V{y}"},
+  {0x8000, 0x6, Op::SHR, "SHR V{x}, V{y}"},
+  {0x8000, 0x7, Op::SUBN, "SUBN V{x}, V{y}"},
+  {0x8000, 0xE, Op::SHL, "SHL V{x}, V{y}"},
+  {0x9000, 0x0, Op::SNE_REG, "SNE V{x}, V{y}"},
+  {0xA000, 0x0, Op::LD_I, "LD I, {nnn}"},
+  {0xB000, 0x0, Op::JP_V0, "JP V0, {nnn}"},
+  {0xC000, 0x0, Op::RND, "RND V{x}, {kk}"},
+  {0xD000, 0x0, Op::DRW, "DRW V{x}, V{y}, {n}"},
+  {0xE000, 0xE, Op::SKP, "SKP V{x}"},
+  {0xE000, 0x1, Op::SKNP, "SKNP V{x}"},
+  {0xF000, 0x07, Op::LD_VX_DT, "LD V{x}, DT"},
+  {0xF000, 0x0A, Op::LD_K, "LD V{x}, K"},
+  {0xF000, 0x15, Op::LD_DT, "LD DT, V{x}"},
+  {0xF000, 0x18, Op::LD_ST, "LD ST, V{x}"},
+  {0xF000, 0x1E, Op::ADD_I, "ADD I, V{x}"},
+  {0xF000, 0x29, Op::LD_F, "LD F, V{x}"},
+  {0xF000, 0x33, Op::LD_B, "LD B, V{x}"},
+  {0xF000, 0x55, Op::STORE, "LD [I], V{x}"},
+  {0xF000, 0x65, Op::LOAD, "LD V{x}, [I]"}
+};
+
+uint16_t subKeyMask(uint16_t family){
+  switch (family){
+    case 0x0000:
+    case 0x8000:
+    case 0xE000:
+      return 0x000Fu;
+    case 0xF000:
+      return 0x00FFu;
+  }
+  return 0;
+}
+
+const OpInfo* decode(uint16_t opcode){
+  uint16_t family = opcode & OP_CODE_MASK;
+  uint16_t key = opcode & subKeyMask(family);
+  for (const OpInfo &info : OP_TABLE){
+    if (info.family == family && info.key == key){
+      return &info;
+    }
+  }
+  return nullptr;
+}
+
+uint16_t ramWriteLength(uint16_t opcode){
+  if ((opcode & 0xF0FFu) == 0xF033u){
+    return 3;
+  }
+  if ((opcode & 0xF0FFu) == 0xF055u){
+    return ((opcode & VX_MASK) >> 8u) + 1;
+  }
+  return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef OPCODES_H
+#define OPCODES_H
+
+#include <cstddef>
+#include <cstdint>
+
+//Every instruction the interpreter understands.
+enum class Op : uint8_t{
+  CLS, RET, JP, CALL, SE_BYTE, SNE_BYTE, SE_REG, LD_BYTE, ADD_BYTE,
+  LD_REG, OR, AND, XOR, ADD_REG, SUB, SHR, SUBN, SHL, SNE_REG,
+  LD_I, JP_V0, RND, DRW, SKP, SKNP,
+  LD_VX_DT, LD_K, LD_DT, LD_ST, ADD_I, LD_F, LD_B, STORE, LOAD,
+  INVALID
+};
+const size_t OP_COUNT = static_cast<size_t>(Op::INVALID);
+
+/*One row of the decode table shared by Chip8's dispatch maps and the
+disassembler. family is opcode & OP_CODE_MASK; families 0, 8, E and F are
+split again on opcode & subKeyMask(family), everything else has key 0.
+format is the mnemonic with {x} {y} {n} {kk} {nnn} operand placeholders.*/
+struct OpInfo{
+  uint16_t family;
+  uint16_t key;
+  Op op;
+  const char *format;
+};
+
+extern const OpInfo OP_TABLE[OP_COUNT];
+
+uint16_t subKeyMask(uint16_t family);
+//Table row that Chip8 would dispatch opcode to, nullptr if it ignores it
+const OpInfo* decode(uint16_t opcode);
+//Bytes written to RAM from I onwards, only Fx33 and Fx55 write any
+uint16_t ramWriteLength(uint16_t opcode);
+#endif
@@ -0,0 +1,91 @@
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "quirks.h"
+
+const uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+const uint64_t FNV_PRIME = 0x100000001B3ull;
+
+const char* quirkProfileName(QuirkProfile profile){
+  switch (profile){
+    case QuirkProfile::CosmacVIP: return "vip";
+    case QuirkProfile::Chip48: return "chip48";
+    case QuirkProfile::SChip: return "schip";
+    case QuirkProfile::Modern: return "modern";
+    case QuirkProfile::XOChip: return "xochip";
+  }
+  return "unknown";
+}
+
+bool parseQuirkProfile(const std::string &name, QuirkProfile &profile){
+  if (name == "vip"){
+    profile = QuirkProfile::CosmacVIP;
+  }
+  else if (name == "chip48"){
+    profile = QuirkProfile::Chip48;
+  }
+  else if (name == "schip"){
+    profile = QuirkProfile::SChip;
+  }
+  else if (name == "modern"){
+    profile = QuirkProfile::Modern;
+  }
+  else if (name == "xochip"){
+    profile = QuirkProfile::XOChip;
+  }
+  else {
+    return false;
+  }
+  return true;
+}
+
+uint64_t hashROM(const std::string &filename){
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()){
+    return 0;
+  }
+  uint64_t hash = FNV_OFFSET;
+  char byte;
+  while (file.get(byte)){
+    hash ^= static_cast<uint8_t>(byte);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+bool QuirkDatabase::load(const std::string &filename){
+  std::ifstream file(filename);
+  if (!file.is_open()){
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)){
+    if (line.empty() || line[0] == '#'){
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string hash;
+    std::string name;
+    QuirkProfile profile;
+    if (!(fields >> hash >> name) || !parseQuirkProfile(name, profile)){
+      return false;
+    }
+    char *end;
+    errno = 0;
+    uint64_t value = std::strtoull(hash.c_str(), &end, 16);
+    if (*end != '\0' || errno == ERANGE){
+      return false;
+    }
+    profiles[value] = profile;
+  }
+  return true;
+}
+
+QuirkProfile QuirkDatabase::lookup(uint64_t hash, QuirkProfile fallback) const{
+  auto itProfile = profiles.find(hash);
+  if (itProfile != profiles.end()){
+    return itProfile->second;
+  }
+  return fallback;
+}
@@ -0,0 +1,88 @@
+#ifndef QUIRKS_H
+#define QUIRKS_H
+
+#include <cstdint>
+#include <string>
+#include <map>
+
+//Interpreter variants that disagree on a handful of instructions.
+enum class QuirkProfile{
+  CosmacVIP,
+  Chip48,
+  SChip,
+  Modern,
+  XOChip
+};
+
+//Where Fx55/Fx65 leave I after copying V0 through Vx
+enum class IndexIncrement{
+  None,
+  ByX,
+  ByXPlusOne
+};
+
+/*Each profile is a set of compile time flags. The handlers they affect are
+member templates of Chip8 instantiated once per profile, so the flags are
+resolved by the compiler and never tested in cycle().*/
+struct CosmacVIPQuirks{
+  static constexpr bool shiftUsesVy = true; //8xy6/8xyE shift Vy into Vx
+  static constexpr IndexIncrement loadStoreIndex = IndexIncrement::ByXPlusOne; //Fx55/Fx65 move I past the registers
+  static constexpr bool jumpUsesVx = false; //Bxnn jumps to xnn+Vx instead of nnn+V0
+  static constexpr bool logicResetsVF = true; //8xy1/8xy2/8xy3 clear VF
+  static constexpr bool spriteWraps = false; //Dxyn wraps pixels past the edge instead of clipping
+};
+
+//CHIP-48 stops one short, I ends on the last register written.
+struct Chip48Quirks{
+  static constexpr bool shiftUsesVy = false;
+  static constexpr IndexIncrement loadStoreIndex = IndexIncrement::ByX;
+  static constexpr bool jumpUsesVx = true;
+  static constexpr bool logicResetsVF = false;
+  static constexpr bool spriteWraps = false;
+};
+
+//SUPER-CHIP 1.1 leaves I alone.
+struct SChipQuirks{
+  static constexpr bool shiftUsesVy = false;
+  static constexpr IndexIncrement loadStoreIndex = IndexIncrement::None;
+  static constexpr bool jumpUsesVx = true;
+  static constexpr bool logicResetsVF = false;
+  static constexpr bool spriteWraps = false;
+};
+
+//Behaviour of this emulator before profiles existed.
+struct ModernQuirks{
+  static constexpr bool shiftUsesVy = false;
+  static constexpr IndexIncrement loadStoreIndex = IndexIncrement::None;
+  static constexpr bool jumpUsesVx = false;
+  static constexpr bool logicResetsVF = false;
+  static constexpr bool spriteWraps = false;
+};
+
+//XO-CHIP as Octo runs it: VIP loads, stores and shifts, sprites wrap.
+struct XOChipQuirks{
+  static constexpr bool shiftUsesVy = true;
+  static constexpr IndexIncrement loadStoreIndex = IndexIncrement::ByXPlusOne;
+  static constexpr bool jumpUsesVx = false;
+  static constexpr bool logicResetsVF = false;
+  static constexpr bool spriteWraps = true;
+};
+
+const char* quirkProfileName(QuirkProfile profile);
+bool parseQuirkProfile(const std::string &name, QuirkProfile &profile);
+
+//64 bit FNV-1a hash of a ROM file, 0 if it can't be read.
+uint64_t hashROM(const std::string &filename);
+
+/*Maps ROM hashes to the profile they need. The file has one entry per line:
+  <hash in hex> <profile name>
+Blank lines and lines starting with # are ignored.*/
+class QuirkDatabase{
+public:
+  bool load(const std::string &filename);
+  QuirkProfile lookup(uint64_t hash, QuirkProfile fallback = QuirkProfile::Modern) const;
+
+private:
+  std::map<uint64_t, QuirkProfile> profiles;
+};
+#endif
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include "rollback.h"
+
+Rollback::Rollback(Chip8 &chip8, size_t depth) : chip8(chip8), ring(std::max<size_t>(1, depth)) {}
+
+void Rollback::runFrame(Entry &entry){
+  for (int key = 0; key < 16; ++key){
+    chip8.keyboard[key] = (entry.keys >> key) & 1u;
+  }
+  for (int cycle = 0; cycle < CYCLES_PER_FRAME; ++cycle){
+    chip8.cycle();
+  }
+}
+
+void Rollback::advance(){
+  if (rewindFrame != NO_FRAME){
+    auto start = std::chrono::high_resolution_clock::now();
+    chip8.restore(ring[rewindFrame % ring.size()].snapshot);
+    for (uint64_t replay = rewindFrame; replay < frame; ++replay){
+      Entry &entry = ring[replay % ring.size()];
+      if (replay != rewindFrame){
+        chip8.save(entry.snapshot);
+      }
+      if (!entry.confirmed){
+        entry.keys = confirmedKeys;
+      }
+      runFrame(entry);
+      ++replayedFrames;
+    }
+    ++rollbacks;
+    rewindFrame = NO_FRAME;
+    auto end = std::chrono::high_resolution_clock::now();
+    worstReplay = std::max(worstReplay, std::chrono::duration<double>(end - start).count());
+  }
+
+  Entry &entry = ring[frame % ring.size()];
+  chip8.save(entry.snapshot);
+  entry.confirmed = entry.aheadFrame == frame;
+  entry.keys = entry.confirmed ? entry.aheadKeys : confirmedKeys;
+  entry.aheadFrame = NO_FRAME;
+  runFrame(entry);
+  ++frame;
+}
+
+void Rollback::confirm(uint64_t confirmed, uint16_t keys){
+  if (confirmed >= frame){
+    if (confirmed - frame >= ring.size()){
+      ++tooEarly;
+      return;
+    }
+    //Held apart from the slot's snapshot, which may still be rewound to
+    Entry &entry = ring[confirmed % ring.size()];
+    entry.aheadFrame = confirmed;
+    entry.aheadKeys = keys;
+    confirmedKeys = keys;
+    return;
+  }
+  confirmedKeys = keys;
+  if (frame - confirmed > ring.size()){
+    ++tooLate;
+    return;
+  }
+  Entry &entry = ring[confirmed % ring.size()];
+  entry.confirmed = true;
+  //Later frames ran on the old prediction, a changed prediction means they are wrong too
+  bool laterMispredicted = confirmed + 1 < frame && !ring[(confirmed + 1) % ring.size()].confirmed &&
+                           ring[(confirmed + 1) % ring.size()].keys != keys;
+  if (entry.keys != keys){
+    entry.keys = keys;
+    rewindFrame = std::min(rewindFrame, confirmed);
+  }
+  else if (laterMispredicted){
+    rewindFrame = std::min(rewindFrame, confirmed + 1);
+  }
+}
+
+LatencyInput::LatencyInput(uint64_t delay, uint64_t jitter, uint32_t seed)
+    : delay(delay), jitter(jitter), generator(seed) {}
+
+void LatencyInput::push(uint64_t frame, uint16_t keys){
+  uint64_t due = frame + delay + (jitter > 0 ? generator() % (jitter + 1) : 0);
+  if (!queue.empty()){
+    due = std::max(due, queue.back().due);
+  }
+  queue.push_back({due, frame, keys});
+}
+
+bool LatencyInput::poll(uint64_t now, uint64_t &frame, uint16_t &keys){
+  if (queue.empty() || queue.front().due > now){
+    return false;
+  }
+  frame = queue.front().frame;
+  keys = queue.front().keys;
+  queue.pop_front();
+  return true;
+}
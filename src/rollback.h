@@ -0,0 +1,78 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+#include "chip8.h"
+
+const size_t ROLLBACK_DEPTH = 8;//frames kept for rewinding, 8 * 10 cycles replays well inside 16 ms
+const uint64_t NO_FRAME = UINT64_MAX;
+
+/*Runs a Chip8 ahead of its input. Each frame is CYCLES_PER_FRAME cycles with
+a keyboard bitmask (bit k is key k). Frames whose real keys haven't arrived
+yet run on a prediction, the last confirmed keys held down, and the state at
+the start of every frame goes into a ring of depth snapshots. When confirm()
+brings keys that differ from what a frame ran with, the next advance()
+restores that frame's snapshot and replays up to the present before running
+the new frame. Keys for frames that haven't run yet wait in that frame's
+ring entry. Confirmations must arrive in frame order; ones older than the
+ring only update the prediction and ones a whole ring ahead are dropped.*/
+class Rollback{
+public:
+  explicit Rollback(Chip8 &chip8, size_t depth = ROLLBACK_DEPTH);
+  void advance();
+  void confirm(uint64_t frame, uint16_t keys);
+
+  uint64_t getFrame() const { return frame; }//frames run so far
+  uint64_t getRollbacks() const { return rollbacks; }
+  uint64_t getReplayedFrames() const { return replayedFrames; }
+  uint64_t getTooLate() const { return tooLate; }//confirmations older than the ring
+  uint64_t getTooEarly() const { return tooEarly; }//confirmations a ring or more ahead
+  double getWorstReplay() const { return worstReplay; }//seconds spent in the longest replay
+
+private:
+  struct Entry{
+    Chip8Snapshot snapshot;//machine before the frame ran
+    uint16_t keys{};
+    bool confirmed{};
+    uint64_t aheadFrame{NO_FRAME};//frame sharing this slot whose keys arrived before it ran
+    uint16_t aheadKeys{};
+  };
+  void runFrame(Entry &entry);
+
+  Chip8 &chip8;
+  std::vector<Entry> ring;
+  uint64_t frame{};
+  uint16_t confirmedKeys{};
+  uint64_t rewindFrame{NO_FRAME};
+  uint64_t rollbacks{};
+  uint64_t replayedFrames{};
+  uint64_t tooLate{};
+  uint64_t tooEarly{};
+  double worstReplay{};
+};
+
+/*Stands in for a slow input path. Keys sampled for a frame come out of
+poll() delay frames later, plus up to jitter more, never overtaking keys
+sampled earlier.*/
+class LatencyInput{
+public:
+  LatencyInput(uint64_t delay, uint64_t jitter, uint32_t seed);
+  void push(uint64_t frame, uint16_t keys);
+  //Next keys delivered by now, false when nothing is due
+  bool poll(uint64_t now, uint64_t &frame, uint16_t &keys);
+
+private:
+  struct Pending{
+    uint64_t due;
+    uint64_t frame;
+    uint16_t keys;
+  };
+  uint64_t delay;
+  uint64_t jitter;
+  std::mt19937 generator;
+  std::deque<Pending> queue;
+};
+#endif
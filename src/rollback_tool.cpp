@@ -0,0 +1,104 @@
+#include "conformance.h"
+#include "rollback.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+/*Plays scripted input into a ROM twice: once straight into a reference
+machine, once through a LatencyInput into a Rollback. Once the last input
+has been delivered both must be in the same state, and every replay must
+fit in one 60 Hz frame. Returns false and says why when either fails.*/
+bool checkRollback(const std::string &romName, const std::vector<uint8_t> &rom, long frames,
+                   uint64_t latency, uint64_t jitter, QuirkProfile profile){
+  Chip8 reference(profile);
+  Chip8 chip8(profile);
+  for (Chip8 *machine : {&reference, &chip8}){
+    machine->loadROM(rom.data(), rom.size());
+    machine->seed(1);
+  }
+  //The ring has to reach back past the slowest delivery
+  Rollback rollback(chip8, std::max<size_t>(ROLLBACK_DEPTH, latency + jitter + 1));
+  LatencyInput input(latency, jitter, 2);
+
+  //Keys are held for a few frames at a time, like a player would
+  std::mt19937 script(3);
+  uint16_t keys = 0;
+  long total = frames + latency + jitter + 1;//the tail holds the last keys until everything is delivered
+  for (long frame = 0; frame < total; ++frame){
+    if (frame < frames && script() % 8 == 0){
+      keys = script() % 3 == 0 ? 0 : 1u << (script() % 16);
+    }
+    for (int key = 0; key < 16; ++key){
+      reference.keyboard[key] = (keys >> key) & 1u;
+    }
+    for (int cycle = 0; cycle < CYCLES_PER_FRAME; ++cycle){
+      reference.cycle();
+    }
+
+    input.push(frame, keys);
+    uint64_t confirmed;
+    uint16_t confirmedKeys;
+    while (input.poll(frame, confirmed, confirmedKeys)){
+      rollback.confirm(confirmed, confirmedKeys);
+    }
+    rollback.advance();
+  }
+
+  double budget = 1.0 / 60;
+  std::cout << romName << ": " << total << " frames, " << rollback.getRollbacks() << " rollbacks, "
+            << rollback.getReplayedFrames() << " frames replayed, "
+            << rollback.getTooLate() << " too late for the ring, worst replay "
+            << rollback.getWorstReplay() * 1000 << " ms of " << budget * 1000 << " ms" << std::endl;
+
+  Chip8Snapshot expected;
+  Chip8Snapshot actual;
+  reference.save(expected);
+  chip8.save(actual);
+  if (expected.state != actual.state || expected.generator != actual.generator){
+    std::cout << "State differs from the reference\n" << describeDifference(expected.state, actual.state);
+    return false;
+  }
+  if (rollback.getWorstReplay() > budget){
+    std::cout << "Replay overran the frame budget" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//With - for the ROM, checks the bundled conformance ROMs and a fuzz ROM instead
+int main(int argc, char **argv){
+  if (argc < 4 || argc > 6){
+    std::cerr << "Usage: " << argv[0] << " <ROM|-> <Frames> <Latency> [Jitter] [vip|chip48|schip|modern|xochip]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  std::vector<TestROM> roms;
+  if (std::string(argv[1]) == "-"){
+    roms = bundledROMs();
+    roms.push_back({"fuzz", fuzzROM(1, 256)});
+  }
+  else {
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()){
+      std::cerr << "Could not read " << argv[1] << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    roms.push_back({argv[1], std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>())});
+  }
+  long frames = std::stol(argv[2]);
+  uint64_t latency = std::stoul(argv[3]);
+  uint64_t jitter = argc > 4 ? std::stoul(argv[4]) : 0;
+  QuirkProfile profile = QuirkProfile::Modern;
+  if (argc > 5 && !parseQuirkProfile(argv[5], profile)){
+    std::cerr << "Unknown quirk profile " << argv[5] << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  bool passed = true;
+  for (const TestROM &rom : roms){
+    passed = checkRollback(rom.name, rom.bytes, frames, latency, jitter, profile) && passed;
+  }
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include "opcodes.h"
+#include "simple_chip8.h"
+
+template <typename Q>
+constexpr SimpleChip8::Quirks SimpleChip8::quirksOf(){
+  return {Q::shiftUsesVy, Q::loadStoreIndex, Q::jumpUsesVx, Q::logicResetsVF, Q::spriteWraps};
+}
+
+SimpleChip8::SimpleChip8(QuirkProfile profile){
+  switch (profile){
+    case QuirkProfile::CosmacVIP: quirks = quirksOf<CosmacVIPQuirks>(); break;
+    case QuirkProfile::Chip48: quirks = quirksOf<Chip48Quirks>(); break;
+    case QuirkProfile::SChip: quirks = quirksOf<SChipQuirks>(); break;
+    case QuirkProfile::Modern: quirks = quirksOf<ModernQuirks>(); break;
+    case QuirkProfile::XOChip: quirks = quirksOf<XOChipQuirks>(); break;
+  }
+  //The same glyphs Chip8 loads, 5 rows of 4 pixels per hex digit
+  static const uint8_t FONT[FONTSET_SIZE] = {
+    0xF0, 0x90, 0x90, 0x90, 0xF0, 0x20, 0x60, 0x20, 0x20, 0x70, 0xF0, 0x10, 0xF0, 0x80, 0xF0,
+    0xF0, 0x10, 0xF0, 0x10, 0xF0, 0x90, 0x90, 0xF0, 0x10, 0x10, 0xF0, 0x80, 0xF0, 0x10, 0xF0,
+    0xF0, 0x80, 0xF0, 0x90, 0xF0, 0xF0, 0x10, 0x20, 0x40, 0x40, 0xF0, 0x90, 0xF0, 0x90, 0xF0,
+    0xF0, 0x90, 0xF0, 0x10, 0xF0, 0xF0, 0x90, 0xF0, 0x90, 0x90, 0xE0, 0x90, 0xE0, 0x90, 0xE0,
+    0xF0, 0x80, 0x80, 0x80, 0xF0, 0xE0, 0x90, 0x90, 0x90, 0xE0, 0xF0, 0x80, 0xF0, 0x80, 0xF0,
+    0xF0, 0x80, 0xF0, 0x80, 0x80};
+  std::copy(FONT, FONT + FONTSET_SIZE, ram.begin() + FONTSET_START_ADDR);
+}
+
+void SimpleChip8::loadROM(const uint8_t *data, size_t size){
+  size = std::min(size, ram.size() - PROG_START_ADDR);
+  std::copy(data, data + size, ram.begin() + PROG_START_ADDR);
+}
+
+void SimpleChip8::seed(uint32_t value){
+  generator.seed(value);
+  randByte.reset();
+}
+
+Chip8State SimpleChip8::save() const{
+  Chip8State state;
+  state.ram = ram;
+  state.registers = V;
+  state.stack = stack;
+  state.index = I;
+  state.delay = delay;
+  state.sound = sound;
+  state.programCounter = pc;
+  state.stackPointer = sp;
+  std::copy(keyboard, keyboard + 16, state.keyboard.begin());
+  state.display = display;
+  return state;
+}
+
+void SimpleChip8::cycle(){
+  uint16_t opcode = (ram[pc] << 8u) | ram[pc + 1];
+  pc += 2;
+  execute(opcode);
+  if (delay > 0){
+    --delay;
+  }
+  if (sound > 0){
+    --sound;
+  }
+}
+
+void SimpleChip8::execute(uint16_t opcode){
+  const OpInfo *info = decode(opcode);
+  if (!info){
+    return;
+  }
+  uint8_t x = (opcode >> 8u) & 0xFu;
+  uint8_t y = (opcode >> 4u) & 0xFu;
+  uint8_t n = opcode & 0xFu;
+  uint8_t kk = opcode & 0xFFu;
+  uint16_t nnn = opcode & 0xFFFu;
+  //8xyN reads both operands before writing anything, Vx first and VF last
+  uint8_t a = V[x];
+  uint8_t b = V[y];
+  switch (info->op){
+    case Op::CLS: display.fill(0); break;
+    case Op::RET: pc = stack[--sp]; break;
+    case Op::JP: pc = nnn; break;
+    case Op::CALL: stack[sp++] = pc; pc = nnn; break;
+    case Op::SE_BYTE: if (a == kk) pc += 2; break;
+    case Op::SNE_BYTE: if (a != kk) pc += 2; break;
+    case Op::SE_REG: if (a == b) pc += 2; break;
+    case Op::SNE_REG: if (a != b) pc += 2; break;
+    case Op::LD_BYTE: V[x] = kk; break;
+    case Op::ADD_BYTE: V[x] = a + kk; break;
+    case Op::LD_REG: V[x] = b; break;
+    case Op::OR: V[x] = a | b; if (quirks.logicResetsVF) V[0xF] = 0; break;
+    case Op::AND: V[x] = a & b; if (quirks.logicResetsVF) V[0xF] = 0; break;
+    case Op::XOR: V[x] = a ^ b; if (quirks.logicResetsVF) V[0xF] = 0; break;
+    case Op::ADD_REG: V[x] = a + b; V[0xF] = a + b > 0xFF ? 1 : 0; break;
+    case Op::SUB: V[x] = a - b; V[0xF] = a >= b ? 1 : 0; break;
+    case Op::SUBN: V[x] = b - a; V[0xF] = b >= a ? 1 : 0; break;
+    case Op::SHR: {
+      uint8_t source = quirks.shiftUsesVy ? b : a;
+      V[x] = source >> 1;
+      V[0xF] = source & 1;
+    } break;
+    case Op::SHL: {
+      uint8_t source = quirks.shiftUsesVy ? b : a;
+      V[x] = source << 1;
+      V[0xF] = (source & 0x80) ? 1 : 0;
+    } break;
+    case Op::LD_I: I = nnn; break;
+    case Op::JP_V0: pc = nnn + (quirks.jumpUsesVx ? a : V[0]); break;
+    case Op::RND: V[x] = randByte(generator) & kk; break;
+    case Op::DRW: draw(a, b, n); break;
+    case Op::SKP: if (keyboard[a & 0xF]) pc += 2; break;
+    case Op::SKNP: if (!keyboard[a & 0xF]) pc += 2; break;
+    case Op::LD_VX_DT: V[x] = delay; break;
+    case Op::LD_K: {
+      int key = 0;
+      while (key < 16 && !keyboard[key]){
+        ++key;
+      }
+      if (key < 16){
+        V[x] = key;
+      }
+      else {
+        pc -= 2;//run this instruction again until a key is down
+      }
+    } break;
+    case Op::LD_DT: delay = a; break;
+    case Op::LD_ST: sound = a; break;
+    case Op::ADD_I: I += a; break;
+    case Op::LD_F: I = FONTSET_START_ADDR + 5 * a; break;
+    case Op::LD_B:
+      ram[I] = a / 100;
+      ram[I + 1] = a / 10 % 10;
+      ram[I + 2] = a % 10;
+      break;
+    case Op::STORE:
+    case Op::LOAD:
+      for (int i = 0; i <= x; ++i){
+        if (info->op == Op::STORE){
+          ram[I + i] = V[i];
+        }
+        else {
+          V[i] = ram[I + i];
+        }
+      }
+      if (quirks.loadStoreIndex == IndexIncrement::ByXPlusOne){
+        I += x + 1;
+      }
+      else if (quirks.loadStoreIndex == IndexIncrement::ByX){
+        I += x;
+      }
+      break;
+    case Op::INVALID: break;
+  }
+}
+
+void SimpleChip8::draw(uint8_t x, uint8_t y, uint8_t n){
+  V[0xF] = 0;
+  for (int row = 0; row < n; ++row){
+    int py = y % DISP_H + row;
+    if (quirks.spriteWraps){
+      py %= DISP_H;
+    }
+    else if (py >= DISP_H){
+      break;
+    }
+    for (int col = 0; col < 8; ++col){
+      int px = x % DISP_W + col;
+      if (quirks.spriteWraps){
+        px %= DISP_W;
+      }
+      else if (px >= DISP_W){
+        break;
+      }
+      if (!(ram[I + row] & (0x80u >> col))){
+        continue;
+      }
+      uint32_t &pixel = display[py * DISP_W + px];
+      if (pixel == 0xFFFFFFFF){
+        V[0xF] = 1;
+      }
+      pixel ^= 0xFFFFFFFF;
+    }
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef SIMPLE_CHIP8_H
+#define SIMPLE_CHIP8_H
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include "chip8.h"
+
+/*Second interpreter for the conformance suite, written to be obviously
+right rather than fast: one switch over the decoded Op, quirks read from
+plain bools at run time. It shares only the decode table with Chip8, so a
+mistake in Chip8's handlers, dispatch tables or quirk templates shows up as
+a divergence instead of being compared against itself.*/
+class SimpleChip8{
+public:
+  explicit SimpleChip8(QuirkProfile profile);
+  void loadROM(const uint8_t *data, size_t size);
+  void seed(uint32_t value);
+  void cycle();
+  Chip8State save() const;
+  uint8_t keyboard[16]{};
+
+private:
+  struct Quirks{
+    bool shiftUsesVy;
+    IndexIncrement loadStoreIndex;
+    bool jumpUsesVx;
+    bool logicResetsVF;
+    bool spriteWraps;
+  };
+  template <typename Q> static constexpr Quirks quirksOf();
+  void execute(uint16_t opcode);
+  void draw(uint8_t x, uint8_t y, uint8_t n);
+
+  Quirks quirks{};
+  std::array<uint8_t,4096> ram{};
+  std::array<uint8_t,16> V{};
+  std::array<uint16_t,16> stack{};
+  std::array<uint32_t,DISP_W * DISP_H> display{};
+  uint16_t I{};
+  uint8_t delay{};
+  uint8_t sound{};
+  uint16_t pc{PROG_START_ADDR};
+  uint8_t sp{};
+  std::mt19937 generator;
+  std::uniform_int_distribution<uint8_t> randByte{0, 155};//same range as Chip8
+};
+#endif
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include "analysis.h"
+#include "opcodes.h"
+#include "timing.h"
+
+const uint16_t FETCH_CYCLES = 18;
+const uint16_t DRAW_ROW_CYCLES = 46;//shift one sprite byte into place and XOR two display bytes
+const uint16_t MAX_BLOCK_LENGTH = 64;
+
+uint16_t vipCycleCost(uint16_t opcode){
+  const OpInfo *info = decode(opcode);
+  if (!info){
+    return FETCH_CYCLES;
+  }
+  uint16_t x = (opcode & VX_MASK) >> 8u;
+  switch (info->op){
+    case Op::CLS: return FETCH_CYCLES + 666;
+    case Op::RET: return FETCH_CYCLES + 10;
+    case Op::JP: return FETCH_CYCLES + 12;
+    case Op::CALL: return FETCH_CYCLES + 26;
+    case Op::SE_BYTE:
+    case Op::SNE_BYTE: return FETCH_CYCLES + 10;
+    case Op::SE_REG:
+    case Op::SNE_REG: return FETCH_CYCLES + 14;
+    case Op::LD_BYTE: return FETCH_CYCLES + 6;
+    case Op::ADD_BYTE: return FETCH_CYCLES + 10;
+    //8xyN builds and runs a one instruction 1802 subroutine
+    case Op::LD_REG:
+    case Op::OR:
+    case Op::AND:
+    case Op::XOR:
+    case Op::ADD_REG:
+    case Op::SUB:
+    case Op::SHR:
+    case Op::SUBN:
+    case Op::SHL: return FETCH_CYCLES + 44;
+    case Op::LD_I: return FETCH_CYCLES + 12;
+    case Op::JP_V0: return FETCH_CYCLES + 22;
+    case Op::RND: return FETCH_CYCLES + 36;
+    case Op::DRW: return FETCH_CYCLES + 26 + DRAW_ROW_CYCLES * (opcode & N_MASK);
+    case Op::SKP:
+    case Op::SKNP: return FETCH_CYCLES + 14;
+    case Op::LD_VX_DT: return FETCH_CYCLES + 10;
+    case Op::LD_K: return FETCH_CYCLES + 14;
+    case Op::LD_DT:
+    case Op::LD_ST: return FETCH_CYCLES + 10;
+    case Op::ADD_I: return FETCH_CYCLES + 16;
+    case Op::LD_F: return FETCH_CYCLES + 16;
+    case Op::LD_B: return FETCH_CYCLES + 120;//repeated subtraction per digit
+    case Op::STORE:
+    case Op::LOAD: return FETCH_CYCLES + 14 + 14 * (x + 1);
+    case Op::INVALID: break;
+  }
+  return FETCH_CYCLES;
+}
+
+const FrameScheduler::Block& FrameScheduler::blockAt(uint16_t pc){
+  Block &block = blocks[pc & NNN_MASK];
+  if (block.length > 0){
+    return block;
+  }
+  const std::array<uint8_t,4096> &ram = chip8.getRAM();
+  uint16_t address = pc & NNN_MASK;
+  while (true){
+    uint16_t opcode = (ram[address] << 8u) | ram[(address + 1) & NNN_MASK];
+    block.cost += vipCycleCost(opcode);
+    ++block.length;
+    cachedCode[address] = true;
+    cachedCode[(address + 1) & NNN_MASK] = true;
+    const OpInfo *info = decode(opcode);
+    block.drawsSprite = info && info->op == Op::DRW;
+    block.writesRAM = ramWriteLength(opcode) > 0;
+    if (endsBlock(opcode) || block.drawsSprite || block.writesRAM || block.length == MAX_BLOCK_LENGTH){
+      break;
+    }
+    address = (address + 2) & NNN_MASK;
+  }
+  return block;
+}
+
+void FrameScheduler::runFrame(){
+  int32_t budget = VIP_FRAME_BUDGET - carried;
+  while (budget > 0){
+    //Copy, a write at the end of the block may clear the cache
+    Block block = blockAt(chip8.getProgramCounter());
+    for (uint16_t i = 1; i < block.length; ++i){
+      chip8.step();
+    }
+    if (block.writesRAM){
+      uint16_t pc = chip8.getProgramCounter();
+      uint16_t opcode = (chip8.getRAM()[pc] << 8u) | chip8.getRAM()[(pc + 1) & NNN_MASK];
+      uint16_t start = chip8.getIndex();
+      bool hitsCode = false;
+      for (uint16_t offset = 0; offset < ramWriteLength(opcode); ++offset){
+        hitsCode |= cachedCode[(start + offset) & NNN_MASK];
+      }
+      chip8.step();
+      if (hitsCode){
+        reset();
+      }
+    }
+    else {
+      chip8.step();
+    }
+    budget -= block.cost;
+    instructions += block.length;
+    machineCycles += block.cost;
+    if (block.drawsSprite){
+      //Idle until the next vertical blank
+      budget = std::min(budget, 0);
+      break;
+    }
+  }
+  carried = -budget;
+  chip8.tickTimers();
+  ++frames;
+}
+
+void FrameScheduler::reset(){
+  blocks.fill(Block{});
+  cachedCode.reset();
+  carried = 0;
+}
+
+double FrameScheduler::emulatedMHz(double seconds) const{
+  if (seconds <= 0){
+    return 0;
+  }
+  return frames * double(VIP_CYCLES_PER_FRAME) * VIP_CLOCKS_PER_MACHINE_CYCLE / seconds / 1e6;
+}
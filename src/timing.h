@@ -0,0 +1,59 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include "chip8.h"
+
+/*COSMAC VIP timing. The 1802 runs at 1.7609 MHz and spends 8 clocks per
+machine cycle, so a 60 Hz frame is 3668 machine cycles. The video DMA and
+the interrupt routine that feeds it take their share before the interpreter
+sees any, what is left is the budget for CHIP-8 instructions.*/
+const uint32_t VIP_CLOCK_HZ = 1760900;
+const uint32_t VIP_CLOCKS_PER_MACHINE_CYCLE = 8;
+const int32_t VIP_CYCLES_PER_FRAME = VIP_CLOCK_HZ / VIP_CLOCKS_PER_MACHINE_CYCLE / 60;
+const int32_t VIP_DISPLAY_CYCLES = 1124;//128 lines of 8 DMA bytes plus the interrupt routine
+const int32_t VIP_FRAME_BUDGET = VIP_CYCLES_PER_FRAME - VIP_DISPLAY_CYCLES;
+
+//Machine cycles the VIP interpreter spends on opcode, fetch and decode
+//included. Approximate, taken from the length of each handler's path.
+uint16_t vipCycleCost(uint16_t opcode);
+
+/*Runs a Chip8 in 60 Hz frames of VIP machine cycles instead of a fixed
+count of instructions per frame. Cost is accounted per straight line block:
+the first visit to an address sums the costs up to the next branch, DRW or
+RAM write, and later visits charge that sum once and step the whole block
+without looking at the budget in between. Overshoot is carried into the
+next frame. DRW waits for vertical blank on the VIP, so a block that draws
+ends the frame. Blocks are dropped when the program writes over them.*/
+class FrameScheduler{
+public:
+  explicit FrameScheduler(Chip8 &chip8) : chip8(chip8) {}
+  void runFrame();//one frame of instructions, then one timer tick
+  void reset();//forget cached blocks and carried cycles, e.g. after Chip8::restore
+
+  uint64_t getFrames() const { return frames; }
+  uint64_t getInstructions() const { return instructions; }
+  uint64_t getMachineCycles() const { return machineCycles; }
+  //VIP clock emulated per second of host time, 1.76 is real time
+  double emulatedMHz(double seconds) const;
+
+private:
+  struct Block{
+    uint16_t length{};//instructions, 0 until first visited
+    uint16_t cost{};
+    bool drawsSprite{};
+    bool writesRAM{};
+  };
+  const Block& blockAt(uint16_t pc);
+
+  Chip8 &chip8;
+  std::array<Block,4096> blocks{};
+  std::bitset<4096> cachedCode;//bytes covered by some cached block
+  int32_t carried{};
+  uint64_t frames{};
+  uint64_t instructions{};
+  uint64_t machineCycles{};
+};
+#endif
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cstring>
+#include "trace.h"
+
+TraceWriter::TraceWriter(const std::string &filename) : active(TRACE_BUFFER_SIZE + TRACE_RECORD_MAX){
+  file = std::fopen(filename.c_str(), "wb");
+  if (!file){
+    return;
+  }
+  pending.resize(active.size());
+  std::copy(TRACE_MAGIC, TRACE_MAGIC + sizeof(TRACE_MAGIC), active.begin());
+  active[sizeof(TRACE_MAGIC)] = TRACE_VERSION;
+  used = sizeof(TRACE_MAGIC) + 1;
+  writer = std::thread(&TraceWriter::writeLoop, this);
+}
+
+TraceWriter::~TraceWriter(){
+  if (!file){
+    return;
+  }
+  if (used){
+    handOff();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  ready.notify_one();
+  writer.join();
+  std::fclose(file);
+}
+
+void TraceWriter::handOff(){
+  std::unique_lock<std::mutex> lock(mutex);
+  //Only blocks when the disk is slower than the emulator
+  idle.wait(lock, [this]{ return pendingUsed == 0; });
+  std::swap(active, pending);
+  pendingUsed = used;
+  used = 0;
+  lock.unlock();
+  ready.notify_one();
+}
+
+void TraceWriter::writeLoop(){
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true){
+    ready.wait(lock, [this]{ return pendingUsed || stopping; });
+    if (!pendingUsed){
+      break;
+    }
+    lock.unlock();
+    std::fwrite(pending.data(), 1, pendingUsed, file);
+    lock.lock();
+    pendingUsed = 0;
+    idle.notify_one();
+  }
+}
+
+TraceReader::TraceReader(const std::string &filename) : file(filename, std::ios::binary){
+  char header[sizeof(TRACE_MAGIC) + 1];
+  if (file.read(header, sizeof(header))){
+    valid = std::memcmp(header, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0 &&
+            static_cast<uint8_t>(header[sizeof(TRACE_MAGIC)]) == TRACE_VERSION;
+  }
+}
+
+bool TraceReader::next(TraceRecord &record){
+  if (!valid){
+    return false;
+  }
+  int32_t pcDelta;
+  if (!getSigned(file, pcDelta)){
+    return false;//clean end of trace
+  }
+  char opcode[2];
+  if (!file.read(opcode, 2) || !getVarint(file, record.mask)){
+    valid = false;
+    return false;
+  }
+  record.number = count++;
+  lastPC += pcDelta;
+  record.pc = lastPC;
+  record.opcode = (static_cast<uint8_t>(opcode[0]) << 8u) | static_cast<uint8_t>(opcode[1]);
+  for (int i = 0; i < 16; ++i){
+    if (record.mask & (1u << i)){
+      record.registers[i] = file.get();
+    }
+  }
+  if (record.mask & TRACE_INDEX){
+    int32_t indexDelta = 0;
+    getSigned(file, indexDelta);
+    lastIndex += indexDelta;
+  }
+  record.index = lastIndex;
+  if (record.mask & TRACE_SP){
+    record.stackPointer = file.get();
+  }
+  if (record.mask & TRACE_DELAY){
+    record.delay = file.get();
+  }
+  if (record.mask & TRACE_SOUND){
+    record.sound = file.get();
+  }
+  record.memory.clear();
+  if (record.mask & TRACE_MEMORY){
+    uint32_t address = 0;
+    uint32_t size = 0;
+    getVarint(file, address);
+    getVarint(file, size);
+    record.memoryAddress = address;
+    record.memory.resize(size);
+    file.read(reinterpret_cast<char *>(record.memory.data()), size);
+  }
+  if (!file){
+    valid = false;
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,106 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "varint.h"
+
+/*Binary execution trace, one record per instruction:
+  varint  zigzag(pc - previous pc)
+  2 bytes opcode
+  varint  change mask, bits 0-15 V0-VF, then TRACE_* bits below
+  1 byte  per changed register, in register order
+  varint  zigzag(I - previous I)          if TRACE_INDEX
+  1 byte  stack pointer                   if TRACE_SP
+  1 byte  delay timer                     if TRACE_DELAY
+  1 byte  sound timer                     if TRACE_SOUND
+  varint  address, varint count, bytes    if TRACE_MEMORY
+The file starts with TRACE_MAGIC and a version byte.*/
+const char TRACE_MAGIC[4] = {'C', '8', 'T', 'R'};
+const uint8_t TRACE_VERSION = 1;
+const uint32_t TRACE_INDEX = 1u << 16u;
+const uint32_t TRACE_SP = 1u << 17u;
+const uint32_t TRACE_DELAY = 1u << 18u;
+const uint32_t TRACE_SOUND = 1u << 19u;
+const uint32_t TRACE_MEMORY = 1u << 20u;
+const size_t TRACE_BUFFER_SIZE = 1u << 16u;
+const size_t TRACE_RECORD_MAX = 64;//largest record is 49 bytes, a 16 byte store changing every register
+
+//Encodes records into one buffer while a background thread writes the other.
+class TraceWriter{
+public:
+  explicit TraceWriter(const std::string &filename);
+  ~TraceWriter();
+  bool isOpen() const { return file != nullptr; }
+
+  /*Records are encoded straight into the buffer through a local pointer:
+  begin() returns where the next record goes, with room for TRACE_RECORD_MAX
+  bytes, and endRecord() takes the pointer past its last byte. Once the
+  buffer is full it goes to the writer thread, or is dropped without a file.*/
+  uint8_t *begin(){ return active.data() + used; }
+  void endRecord(uint8_t *end){
+    used = end - active.data();
+    if (used >= TRACE_BUFFER_SIZE){
+      if (file){
+        handOff();
+      }
+      else {
+        used = 0;
+      }
+    }
+  }
+  uint16_t lastPC{};
+  uint16_t lastIndex{};
+
+private:
+  void handOff();
+  void writeLoop();
+
+  std::FILE *file{};
+  std::vector<uint8_t> active;
+  std::vector<uint8_t> pending;
+  size_t used{};//bytes of active holding records
+  size_t pendingUsed{};//bytes of pending still to be written
+  std::mutex mutex;
+  std::condition_variable ready;
+  std::condition_variable idle;
+  bool stopping{};
+  std::thread writer;
+};
+
+struct TraceRecord{
+  uint64_t number{};//position of the instruction in the trace, from 0
+  uint16_t pc{};
+  uint16_t opcode{};
+  uint32_t mask{};
+  std::array<uint8_t,16> registers{};//only entries flagged in mask are valid
+  uint16_t index{};
+  uint8_t stackPointer{};
+  uint8_t delay{};
+  uint8_t sound{};
+  uint16_t memoryAddress{};
+  std::vector<uint8_t> memory;
+};
+
+//Decodes a trace one record at a time so it never has to fit in memory.
+class TraceReader{
+public:
+  explicit TraceReader(const std::string &filename);
+  bool isOpen() const { return valid; }
+  bool next(TraceRecord &record);
+
+private:
+  std::ifstream file;
+  bool valid{};
+  uint64_t count{};
+  uint16_t lastPC{};
+  uint16_t lastIndex{};
+};
+#endif
@@ -0,0 +1,120 @@
+#include "chip8.h"
+#include "disasm.h"
+#include "quirks.h"
+#include "trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+//Records execution traces and answers queries about them by streaming
+//through the file, so traces larger than memory are fine.
+void usage(const char *program){
+  std::cerr << "Usage: " << program << " record <ROM> <Cycles> <Trace> [vip|chip48|schip|modern|xochip]\n"
+            << "       " << program << " dump <Trace>\n"
+            << "       " << program << " pc <Trace> <Address>\n"
+            << "       " << program << " writes <Trace> <Address>" << std::endl;
+  std::exit(EXIT_FAILURE);
+}
+
+int record(const std::string &romFilename, long cycles, const std::string &traceFilename, QuirkProfile profile){
+  Chip8 chip8(profile);
+  chip8.loadROM(romFilename);
+  TraceWriter trace(traceFilename);
+  if (!trace.isOpen()){
+    std::cerr << "Could not open " << traceFilename << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  for (long i = 0; i < cycles; ++i){
+    chip8.cycle(trace);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  std::cout << cycles << " cycles traced, " << (seconds > 0 ? cycles / seconds : 0) << " IPS" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+void printRecord(const TraceRecord &record){
+  char line[32];
+  snprintf(line, sizeof(line), "%10llu  %03X  %04X  ", static_cast<unsigned long long>(record.number),
+           record.pc, record.opcode);
+  std::cout << line << disassemble(record.opcode);
+  for (int i = 0; i < 16; ++i){
+    if (record.mask & (1u << i)){
+      snprintf(line, sizeof(line), "  V%X=%02X", i, record.registers[i]);
+      std::cout << line;
+    }
+  }
+  if (record.mask & TRACE_INDEX){
+    snprintf(line, sizeof(line), "  I=%03X", record.index);
+    std::cout << line;
+  }
+  if (record.mask & TRACE_SP){
+    std::cout << "  SP=" << static_cast<int>(record.stackPointer);
+  }
+  if (record.mask & TRACE_MEMORY){
+    snprintf(line, sizeof(line), "  [%03X]=", record.memoryAddress);
+    std::cout << line;
+    for (uint8_t byte : record.memory){
+      snprintf(line, sizeof(line), "%02X", byte);
+      std::cout << line;
+    }
+  }
+  std::cout << "\n";
+}
+
+int main(int argc, char **argv){
+  if (argc < 3){
+    usage(argv[0]);
+  }
+  std::string command = argv[1];
+
+  if (command == "record"){
+    if (argc != 5 && argc != 6){
+      usage(argv[0]);
+    }
+    QuirkProfile profile = QuirkProfile::Modern;
+    if (argc == 6 && !parseQuirkProfile(argv[5], profile)){
+      usage(argv[0]);
+    }
+    return record(argv[2], std::stol(argv[3]), argv[4], profile);
+  }
+
+  TraceReader trace(argv[2]);
+  if (!trace.isOpen()){
+    std::cerr << argv[2] << " is not a trace file" << std::endl;
+    return EXIT_FAILURE;
+  }
+  TraceRecord record;
+
+  if (command == "dump" && argc == 3){
+    while (trace.next(record)){
+      printRecord(record);
+    }
+  }
+  else if (command == "pc" && argc == 4){
+    uint16_t address = std::stoul(argv[3], nullptr, 16);
+    while (trace.next(record)){
+      if (record.pc == address){
+        printRecord(record);
+        return EXIT_SUCCESS;
+      }
+    }
+    std::cout << "PC never reached " << argv[3] << std::endl;
+  }
+  else if (command == "writes" && argc == 4){
+    uint16_t address = std::stoul(argv[3], nullptr, 16);
+    while (trace.next(record)){
+      if ((record.mask & TRACE_MEMORY) && address >= record.memoryAddress &&
+          address < record.memoryAddress + record.memory.size()){
+        printRecord(record);
+      }
+    }
+  }
+  else {
+    usage(argv[0]);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+
+/*LEB128 varints shared by the trace and capture formats: 7 bits per byte,
+low bits first, high bit set on every byte but the last. Signed values are
+zigzag encoded first so small negative deltas stay small.*/
+const size_t VARINT_MAX_BYTES = 5;//a 32 bit value needs at most 5 bytes
+
+//Writes value at out, which needs room for VARINT_MAX_BYTES, and returns the end
+inline uint8_t *putVarint(uint8_t *out, uint32_t value){
+  while (value >= 0x80u){
+    *out++ = static_cast<uint8_t>(value | 0x80u);
+    value >>= 7u;
+  }
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+inline uint8_t *putSigned(uint8_t *out, int32_t value){
+  return putVarint(out, (static_cast<uint32_t>(value) << 1u) ^ static_cast<uint32_t>(value >> 31));
+}
+
+//False at end of stream or on a varint longer than VARINT_MAX_BYTES
+inline bool getVarint(std::istream &in, uint32_t &value){
+  value = 0;
+  for (unsigned shift = 0; shift < 7 * VARINT_MAX_BYTES; shift += 7){
+    int byte = in.get();
+    if (byte == EOF){
+      return false;
+    }
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)){
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool getSigned(std::istream &in, int32_t &value){
+  uint32_t raw;
+  if (!getVarint(in, raw)){
+    return false;
+  }
+  value = static_cast<int32_t>(raw >> 1u) ^ -static_cast<int32_t>(raw & 1u);
+  return true;
+}
+#endif
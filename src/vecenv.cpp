@@ -0,0 +1,128 @@
+#include <algorithm>
+#include "capture.h"
+#include "vecenv.h"
+
+VecEnv::VecEnv(size_t count, const std::vector<uint8_t> &rom, QuirkProfile profile, int framesPerStep,
+               ObservationFormat format, size_t threads)
+    : framesPerStep(framesPerStep), format(format){
+  for (size_t env = 0; env < count; ++env){
+    machines.push_back(std::make_unique<Chip8>(profile));
+    machines.back()->loadROM(rom.data(), rom.size());
+    machines.back()->seed(env);
+  }
+  initial = machines.front()->save();
+  observationBuffer.resize(count * observationSize());
+  rewardBuffer.resize(count);
+
+  //The calling thread works too, as worker 0
+  threadCount = std::max<size_t>(1, std::min(threads, count));
+  for (size_t worker = 1; worker < threadCount; ++worker){
+    workers.emplace_back(&VecEnv::workLoop, this, worker);
+  }
+}
+
+VecEnv::~VecEnv(){
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  start.notify_all();
+  for (std::thread &worker : workers){
+    worker.join();
+  }
+}
+
+size_t VecEnv::observationSize() const{
+  switch (format){
+    case ObservationFormat::Packed: return FRAME_BYTES;
+    case ObservationFormat::Bytes: return DISP_W * DISP_H;
+    case ObservationFormat::Display: break;
+  }
+  return 0;
+}
+
+void VecEnv::reset(){
+  for (size_t env = 0; env < machines.size(); ++env){
+    reset(env);
+  }
+}
+
+void VecEnv::reset(size_t env){
+  //Chip8State leaves the Cxkk generator out, reseed it as the constructor did
+  machines[env]->restore(initial);
+  machines[env]->seed(env);
+  rewardBuffer[env] = 0;
+  writeObservation(env);
+}
+
+void VecEnv::runSlice(size_t begin, size_t end){
+  for (size_t env = begin; env < end; ++env){
+    Chip8 &chip8 = *machines[env];
+    for (int key = 0; key < 16; ++key){
+      chip8.keyboard[key] = (actions[env] >> key) & 1u;
+    }
+    const std::array<uint8_t,4096> &ram = chip8.getRAM();
+    float reward = 0;
+    for (const RewardAddress &address : rewardAddresses){
+      reward -= address.scale * ram[address.address & NNN_MASK];
+    }
+    for (int cycle = 0; cycle < framesPerStep * CYCLES_PER_FRAME; ++cycle){
+      chip8.cycle();
+    }
+    for (const RewardAddress &address : rewardAddresses){
+      reward += address.scale * ram[address.address & NNN_MASK];
+    }
+    rewardBuffer[env] = reward;
+    writeObservation(env);
+  }
+}
+
+void VecEnv::writeObservation(size_t env){
+  const Chip8 &chip8 = *machines[env];
+  uint8_t *out = observationBuffer.data() + env * observationSize();
+  if (format == ObservationFormat::Packed){
+    PackedFrame frame;
+    packFrame(chip8.display, frame);
+    std::copy(frame.begin(), frame.end(), out);
+  }
+  else if (format == ObservationFormat::Bytes){
+    for (int pixel = 0; pixel < DISP_W * DISP_H; ++pixel){
+      out[pixel] = chip8.display[pixel] != 0;
+    }
+  }
+}
+
+void VecEnv::step(const uint16_t *stepActions){
+  actions = stepActions;
+  if (threadCount > 1){
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++generation;
+      remaining = threadCount - 1;
+    }
+    start.notify_all();
+  }
+  runSlice(0, machines.size() / threadCount);
+  if (threadCount > 1){
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]{ return remaining == 0; });
+  }
+}
+
+void VecEnv::workLoop(size_t worker){
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true){
+    start.wait(lock, [&]{ return generation != seen || stopping; });
+    if (stopping){
+      break;
+    }
+    seen = generation;
+    lock.unlock();
+    runSlice(machines.size() * worker / threadCount, machines.size() * (worker + 1) / threadCount);
+    lock.lock();
+    if (--remaining == 0){
+      finished.notify_one();
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "chip8.h"
+
+enum class ObservationFormat{
+  Display,//no copy, read each Chip8's display through observation()
+  Packed,//1bpp, FRAME_BYTES per environment, MSB is the leftmost pixel
+  Bytes//one 0/1 byte per pixel
+};
+
+//Reward is scale times how much the byte at address grew during the step.
+struct RewardAddress{
+  uint16_t address;
+  float scale;
+};
+
+/*Owns count Chip8 machines running the same ROM and steps them together.
+Each step() presses the given keys and runs framesPerStep frames on every
+machine, spread over a fixed pool of worker threads. Observations land in
+one contiguous buffer so callers can wrap it without copying, and reset()
+restores machines from the snapshot taken right after loading the ROM and
+reseeds them, so every episode replays the same random numbers.*/
+class VecEnv{
+public:
+  VecEnv(size_t count, const std::vector<uint8_t> &rom, QuirkProfile profile, int framesPerStep,
+         ObservationFormat format, size_t threads);
+  ~VecEnv();
+
+  void addReward(const RewardAddress &reward){ rewardAddresses.push_back(reward); }
+  void reset();
+  void reset(size_t env);
+  //actions holds one bitmask of pressed keys per machine, bit k is key k
+  void step(const uint16_t *actions);
+
+  size_t size() const { return machines.size(); }
+  const uint32_t* observation(size_t env) const { return machines[env]->display; }
+  const uint8_t* observations() const { return observationBuffer.data(); }
+  size_t observationSize() const;//bytes per machine in observations()
+  const float* rewards() const { return rewardBuffer.data(); }
+
+private:
+  void runSlice(size_t begin, size_t end);
+  void writeObservation(size_t env);
+  void workLoop(size_t worker);
+
+  std::vector<std::unique_ptr<Chip8>> machines;
+  Chip8State initial;
+  int framesPerStep;
+  ObservationFormat format;
+  std::vector<RewardAddress> rewardAddresses;
+  std::vector<uint8_t> observationBuffer;
+  std::vector<float> rewardBuffer;
+  const uint16_t *actions{};
+
+  size_t threadCount{};
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable start;
+  std::condition_variable finished;
+  uint64_t generation{};
+  size_t remaining{};
+  bool stopping{};
+};
+#endif